@@ -1,9 +1,18 @@
 #pragma once
 #include "Private/Core/Utilities/AssertionMacros.h"
 //#include "Private/Core/Utilities/Singleton.h"
+#include "Private/Core/Utilities/SpinMutex.h"
+#include "Private/Core/Utilities/LockStats.h"
 #include "Private/Core/Utilities/LockGuard.h"
+#include "Private/Core/Utilities/Profiler.h"
+#include "Private/Core/Utilities/AllocationTracker.h"
 //#include "Private/Core/Utilities/StringUtils.h"
 
 // Containers
+#include "Private/Core/Utilities/Containers/MPMCRingBuffer.h"
 #include "Private/Core/Utilities/Containers/ProducerConsumerQueue.h"
-#include "Private/Core/Utilities/Containers/ConcurrentQueue.h"
\ No newline at end of file
+#include "Private/Core/Utilities/Containers/ConcurrentQueue.h"
+#include "Private/Core/Utilities/Containers/WorkStealingDeque.h"
+
+// Tasks
+#include "Private/Core/Utilities/TaskScheduler.h"
\ No newline at end of file
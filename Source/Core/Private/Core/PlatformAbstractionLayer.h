@@ -9,6 +9,43 @@
 #include "Private/Core/Platforms/WindowsPlatform.h"
 #elif PLATFORM_MACOS
 #include "Private/Core/Platforms/MacPlatform.h"
+#elif PLATFORM_LINUX
+#include "Private/Core/Platforms/LinuxPlatform.h"
+#endif
+
+//------------------------------------------------------------------
+// Defaults for the hints a platform does not provide
+//------------------------------------------------------------------
+
+#ifndef LIKELY
+#define LIKELY(x)			(x)
+#endif
+#ifndef UNLIKELY
+#define UNLIKELY(x)			(x)
+#endif
+#ifndef PREFETCH
+#define PREFETCH(p)
+#endif
+#ifndef PREFETCH_WRITE
+#define PREFETCH_WRITE(p)
+#endif
+#ifndef CPU_PAUSE
+#define CPU_PAUSE()
+#endif
+#ifndef PLATFORM_CACHE_LINE_SIZE
+#define PLATFORM_CACHE_LINE_SIZE	64
+#endif
+#ifndef OPERATOR_NEW_THROW_SPEC
+#define OPERATOR_NEW_THROW_SPEC
+#endif
+#ifndef OPERATOR_DELETE_THROW_SPEC
+#define OPERATOR_DELETE_THROW_SPEC noexcept
+#endif
+#ifndef OPERATOR_NEW_NOTHROW_SPEC
+#define OPERATOR_NEW_NOTHROW_SPEC noexcept
+#endif
+#ifndef OPERATOR_DELETE_NOTHROW_SPEC
+#define OPERATOR_DELETE_NOTHROW_SPEC noexcept
 #endif
 
 
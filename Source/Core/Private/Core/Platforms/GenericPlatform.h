@@ -53,3 +53,231 @@ struct GenericPlatformTypes
 	typedef int32					TYPE_OF_NULL;
 	typedef decltype(nullptr)		TYPE_OF_NULLPTR;
 };
+
+
+/**
+* A whole file made readable in memory, see PlatformMemory::MapFile
+**/
+struct MappedFileView
+{
+	const std::uint8_t*		Data = nullptr;		// first byte of the file, null for an empty file
+	std::uint64_t			Size = 0;			// length of the file in bytes
+	void*					Handle = nullptr;	// platform specific, released by UnmapFile
+};
+
+/**
+* Access pattern hints for PlatformMemory::Advise
+**/
+enum class EMemoryAdvice
+{
+	Normal,			// no particular pattern
+	Sequential,		// read ahead aggressively, pages can be dropped soon after use
+	Random,			// do not read ahead
+	WillNeed,		// start paging the range in now
+	DontNeed		// the range will not be touched again soon
+};
+
+/**
+* Location of one logical CPU, see PlatformProcess::GetCpuTopology
+**/
+struct CpuTopologyEntry
+{
+	std::uint32_t			LogicalCpu;			// index used for affinity masks
+	std::uint32_t			CoreId;				// physical core, shared by hyperthreads
+	std::uint32_t			PackageId;			// socket
+};
+
+/**
+* Generic memory functions, portable but without any operating system support
+**/
+struct GenericPlatformMemory
+{
+	static std::size_t GetPageSize()
+	{
+		return 4096;
+	}
+
+	/** Reads the whole file into a heap buffer. Returns false if it cannot be read. */
+	static bool MapFile(const char* Path, MappedFileView& OutView)
+	{
+		OutView = MappedFileView();
+		FILE* File = fopen(Path, "rb");
+		if (!File)
+		{
+			return false;
+		}
+		bool bSuccess = fseek(File, 0, SEEK_END) == 0;
+		const long Length = bSuccess ? ftell(File) : -1;
+		bSuccess = Length >= 0 && fseek(File, 0, SEEK_SET) == 0;
+		if (bSuccess && Length > 0)
+		{
+			std::uint8_t* Buffer = new std::uint8_t[Length];
+			bSuccess = fread(Buffer, 1, Length, File) == std::size_t(Length);
+			if (bSuccess)
+			{
+				OutView.Data = Buffer;
+				OutView.Size = Length;
+				OutView.Handle = Buffer;
+			}
+			else
+			{
+				delete[] Buffer;
+			}
+		}
+		fclose(File);
+		return bSuccess;
+	}
+
+	static void UnmapFile(MappedFileView& View)
+	{
+		delete[] static_cast<std::uint8_t*>(View.Handle);
+		View = MappedFileView();
+	}
+
+	static void Advise(const void* /*Address*/, std::size_t /*Size*/, EMemoryAdvice /*Advice*/)
+	{
+	}
+
+	/** Allocates memory meant to be backed by large pages, falls back to regular pages. */
+	static void* AllocateLargePages(std::size_t Size)
+	{
+		return ::operator new(Size, std::nothrow);
+	}
+
+	static void FreeLargePages(void* Address, std::size_t /*Size*/)
+	{
+		::operator delete(Address);
+	}
+
+	/** Largest resident set size of the process so far in bytes, 0 if unknown. */
+	static std::uint64_t GetPeakResidentBytes()
+	{
+		return 0;
+	}
+};
+
+/**
+* Generic timing functions built on std::chrono::steady_clock
+**/
+struct GenericPlatformTime
+{
+	/** Monotonic time in seconds, only meaningful as a difference. */
+	static double Seconds()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/** Cheapest available monotonic counter, convert with GetSecondsPerCycle64. */
+	static std::uint64_t Cycles64()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static double GetSecondsPerCycle64()
+	{
+		return 1e-9;
+	}
+
+	/** CPU time consumed by the calling thread. The generic version can only measure the whole process. */
+	static double ThreadCpuSeconds()
+	{
+		return ProcessCpuSeconds();
+	}
+
+	/** CPU time consumed by all threads of the process. */
+	static double ProcessCpuSeconds()
+	{
+		return double(std::clock()) / CLOCKS_PER_SEC;
+	}
+};
+
+/**
+* Generic CPU and thread functions, affinity is not supported
+**/
+struct GenericPlatformProcess
+{
+	static std::uint32_t NumberOfCoresIncludingHyperthreads()
+	{
+		const unsigned int Count = std::thread::hardware_concurrency();
+		return Count ? Count : 1;
+	}
+
+	static std::uint32_t NumberOfCores()
+	{
+		return NumberOfCoresIncludingHyperthreads();
+	}
+
+	/** Fills OutTopology with one entry per logical CPU this process may run on. */
+	static void GetCpuTopology(std::vector<CpuTopologyEntry>& OutTopology)
+	{
+		OutTopology.clear();
+		for (std::uint32_t Cpu = 0; Cpu < NumberOfCoresIncludingHyperthreads(); ++Cpu)
+		{
+			OutTopology.push_back({ Cpu, Cpu, 0 });
+		}
+	}
+
+	/** Restricts the calling thread to the logical CPUs set in Mask. Returns false if unsupported. */
+	static bool SetThreadAffinityMask(std::uint64_t /*Mask*/)
+	{
+		return false;
+	}
+
+	static bool PinCurrentThreadToCpu(std::uint32_t Cpu)
+	{
+		return Cpu < 64 && SetThreadAffinityMask(std::uint64_t(1) << Cpu);
+	}
+
+	/** Id of the calling process, unique among the running processes. 0 if unknown. */
+	static std::uint32_t GetCurrentProcessId()
+	{
+		return 0;
+	}
+
+	/** Timeout for WaitOnAddress that never expires. */
+	static const std::uint32_t InfiniteWait = 0xFFFFFFFF;
+
+	/**
+	* Blocks while *Address still holds Expected, until WakeOnAddress is called for Address or
+	* TimeoutMs passes. May return spuriously, callers re-check their condition.
+	* Returns false on timeout.
+	* The generic version parks the thread on a mutex and condition variable picked by address.
+	*/
+	static bool WaitOnAddress(const std::atomic<std::uint32_t>* Address, std::uint32_t Expected, std::uint32_t TimeoutMs = InfiniteWait)
+	{
+		AddressWaitBucket& Bucket = GetAddressWaitBucket(Address);
+		std::unique_lock<std::mutex> Lock(Bucket.Mutex);
+		if (Address->load(std::memory_order_acquire) != Expected)
+		{
+			return true;
+		}
+		if (TimeoutMs == InfiniteWait)
+		{
+			Bucket.Condition.wait(Lock);
+			return true;
+		}
+		return Bucket.Condition.wait_for(Lock, std::chrono::milliseconds(TimeoutMs)) == std::cv_status::no_timeout;
+	}
+
+	/** Wakes threads blocked in WaitOnAddress on Address, one or all of them. Store the new value first. */
+	static void WakeOnAddress(const std::atomic<std::uint32_t>* Address, bool /*bWakeAll*/ = false)
+	{
+		// buckets are shared between addresses, so waking a single waiter could pick the wrong one
+		AddressWaitBucket& Bucket = GetAddressWaitBucket(Address);
+		std::lock_guard<std::mutex> Lock(Bucket.Mutex);
+		Bucket.Condition.notify_all();
+	}
+
+private:
+	struct AddressWaitBucket
+	{
+		std::mutex Mutex;
+		std::condition_variable Condition;
+	};
+
+	static AddressWaitBucket& GetAddressWaitBucket(const void* Address)
+	{
+		static AddressWaitBucket Buckets[64];
+		return Buckets[(reinterpret_cast<std::uintptr_t>(Address) >> 4) % 64];
+	}
+};
@@ -0,0 +1,336 @@
+#if PLATFORM_LINUX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*-----------------------------------------------------------------------------
+	LinuxPlatformMemory
+-----------------------------------------------------------------------------*/
+
+std::size_t LinuxPlatformMemory::GetPageSize()
+{
+	static const std::size_t PageSize = std::size_t(sysconf(_SC_PAGESIZE));
+	return PageSize;
+}
+
+bool LinuxPlatformMemory::MapFile(const char* Path, MappedFileView& OutView)
+{
+	OutView = MappedFileView();
+	const int File = open(Path, O_RDONLY | O_CLOEXEC);
+	if (File < 0)
+	{
+		return false;
+	}
+
+	struct stat Info;
+	bool bSuccess = fstat(File, &Info) == 0;
+	if (bSuccess && Info.st_size > 0)
+	{
+		void* Address = mmap(nullptr, std::size_t(Info.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+		bSuccess = Address != MAP_FAILED;
+		if (bSuccess)
+		{
+			OutView.Data = static_cast<const std::uint8_t*>(Address);
+			OutView.Size = std::uint64_t(Info.st_size);
+			OutView.Handle = Address;
+		}
+	}
+	// the mapping keeps its own reference to the file
+	close(File);
+	return bSuccess;
+}
+
+void LinuxPlatformMemory::UnmapFile(MappedFileView& View)
+{
+	if (View.Handle)
+	{
+		munmap(View.Handle, std::size_t(View.Size));
+	}
+	View = MappedFileView();
+}
+
+void LinuxPlatformMemory::Advise(const void* Address, std::size_t Size, EMemoryAdvice Advice)
+{
+	if (!Address || !Size)
+	{
+		return;
+	}
+
+	int Flag = MADV_NORMAL;
+	switch (Advice)
+	{
+		case EMemoryAdvice::Normal:		Flag = MADV_NORMAL; break;
+		case EMemoryAdvice::Sequential:	Flag = MADV_SEQUENTIAL; break;
+		case EMemoryAdvice::Random:		Flag = MADV_RANDOM; break;
+		case EMemoryAdvice::WillNeed:	Flag = MADV_WILLNEED; break;
+		case EMemoryAdvice::DontNeed:	Flag = MADV_DONTNEED; break;
+	}
+
+	// madvise wants a page aligned start
+	const std::uintptr_t PageMask = GetPageSize() - 1;
+	const std::uintptr_t Begin = reinterpret_cast<std::uintptr_t>(Address) & ~PageMask;
+	const std::uintptr_t End = reinterpret_cast<std::uintptr_t>(Address) + Size;
+	madvise(reinterpret_cast<void*>(Begin), End - Begin, Flag);
+}
+
+static std::size_t RoundUpToHugePages(std::size_t Size)
+{
+	return (Size + LinuxPlatformMemory::HugePageSize - 1) & ~(LinuxPlatformMemory::HugePageSize - 1);
+}
+
+void* LinuxPlatformMemory::AllocateLargePages(std::size_t Size)
+{
+	if (!Size)
+	{
+		return nullptr;
+	}
+	const std::size_t Length = RoundUpToHugePages(Size);
+
+#ifdef MAP_HUGETLB
+	void* Address = mmap(nullptr, Length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (Address != MAP_FAILED)
+	{
+		return Address;
+	}
+#endif
+
+	// No reserved huge pages: over-allocate so the range can be trimmed to a huge page
+	// boundary, which transparent huge pages need to back it.
+	const std::size_t Reserved = Length + HugePageSize;
+	char* Mapping = static_cast<char*>(mmap(nullptr, Reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (Mapping == MAP_FAILED)
+	{
+		return nullptr;
+	}
+	char* Aligned = reinterpret_cast<char*>(RoundUpToHugePages(reinterpret_cast<std::uintptr_t>(Mapping)));
+	if (Aligned != Mapping)
+	{
+		munmap(Mapping, Aligned - Mapping);
+	}
+	const std::size_t Tail = (Mapping + Reserved) - (Aligned + Length);
+	if (Tail)
+	{
+		munmap(Aligned + Length, Tail);
+	}
+#ifdef MADV_HUGEPAGE
+	madvise(Aligned, Length, MADV_HUGEPAGE);
+#endif
+	return Aligned;
+}
+
+void LinuxPlatformMemory::FreeLargePages(void* Address, std::size_t Size)
+{
+	if (Address)
+	{
+		munmap(Address, RoundUpToHugePages(Size));
+	}
+}
+
+std::uint64_t LinuxPlatformMemory::GetPeakResidentBytes()
+{
+	struct rusage Usage;
+	if (getrusage(RUSAGE_SELF, &Usage) != 0)
+	{
+		return 0;
+	}
+	return std::uint64_t(Usage.ru_maxrss) * 1024;
+}
+
+/*-----------------------------------------------------------------------------
+	LinuxPlatformTime
+-----------------------------------------------------------------------------*/
+
+static std::uint64_t MonotonicRawNanoseconds()
+{
+	struct timespec Now;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &Now);
+	return std::uint64_t(Now.tv_sec) * 1000000000ull + std::uint64_t(Now.tv_nsec);
+}
+
+double LinuxPlatformTime::Seconds()
+{
+	struct timespec Now;
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+	return double(Now.tv_sec) + double(Now.tv_nsec) * 1e-9;
+}
+
+std::uint64_t LinuxPlatformTime::Cycles64()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return MonotonicRawNanoseconds();
+#endif
+}
+
+double LinuxPlatformTime::GetSecondsPerCycle64()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	static const double SecondsPerCycle = []()
+	{
+		// 10ms against the raw clock is plenty for the accuracy profiling needs
+		const std::uint64_t StartNanoseconds = MonotonicRawNanoseconds();
+		const std::uint64_t StartCycles = __rdtsc();
+		std::uint64_t Nanoseconds;
+		do
+		{
+			Nanoseconds = MonotonicRawNanoseconds() - StartNanoseconds;
+		} while (Nanoseconds < 10000000ull);
+		const std::uint64_t Cycles = __rdtsc() - StartCycles;
+		return Cycles ? double(Nanoseconds) * 1e-9 / double(Cycles) : 1e-9;
+	}();
+	return SecondsPerCycle;
+#else
+	return 1e-9;
+#endif
+}
+
+static double ClockSeconds(clockid_t Clock)
+{
+	struct timespec Now;
+	clock_gettime(Clock, &Now);
+	return double(Now.tv_sec) + double(Now.tv_nsec) * 1e-9;
+}
+
+double LinuxPlatformTime::ThreadCpuSeconds()
+{
+	return ClockSeconds(CLOCK_THREAD_CPUTIME_ID);
+}
+
+double LinuxPlatformTime::ProcessCpuSeconds()
+{
+	return ClockSeconds(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+/*-----------------------------------------------------------------------------
+	LinuxPlatformProcess
+-----------------------------------------------------------------------------*/
+
+static bool ReadSysfsNumber(std::uint32_t Cpu, const char* Entry, std::uint32_t& OutValue)
+{
+	char Path[128];
+	snprintf(Path, sizeof(Path), "/sys/devices/system/cpu/cpu%u/topology/%s", Cpu, Entry);
+	FILE* File = fopen(Path, "r");
+	if (!File)
+	{
+		return false;
+	}
+	const bool bSuccess = fscanf(File, "%u", &OutValue) == 1;
+	fclose(File);
+	return bSuccess;
+}
+
+std::uint32_t LinuxPlatformProcess::NumberOfCoresIncludingHyperthreads()
+{
+	cpu_set_t Set;
+	CPU_ZERO(&Set);
+	if (sched_getaffinity(0, sizeof(Set), &Set) == 0)
+	{
+		const int Count = CPU_COUNT(&Set);
+		if (Count > 0)
+		{
+			return std::uint32_t(Count);
+		}
+	}
+	const long Online = sysconf(_SC_NPROCESSORS_ONLN);
+	return Online > 0 ? std::uint32_t(Online) : 1;
+}
+
+std::uint32_t LinuxPlatformProcess::NumberOfCores()
+{
+	std::vector<CpuTopologyEntry> Topology;
+	GetCpuTopology(Topology);
+	std::set<std::pair<std::uint32_t, std::uint32_t>> Cores;
+	for (const CpuTopologyEntry& Entry : Topology)
+	{
+		Cores.emplace(Entry.PackageId, Entry.CoreId);
+	}
+	return Cores.empty() ? 1 : std::uint32_t(Cores.size());
+}
+
+void LinuxPlatformProcess::GetCpuTopology(std::vector<CpuTopologyEntry>& OutTopology)
+{
+	OutTopology.clear();
+	cpu_set_t Set;
+	CPU_ZERO(&Set);
+	if (sched_getaffinity(0, sizeof(Set), &Set) != 0)
+	{
+		GenericPlatformProcess::GetCpuTopology(OutTopology);
+		return;
+	}
+
+	for (std::uint32_t Cpu = 0; Cpu < CPU_SETSIZE; ++Cpu)
+	{
+		if (!CPU_ISSET(Cpu, &Set))
+		{
+			continue;
+		}
+		CpuTopologyEntry Entry = { Cpu, Cpu, 0 };
+		// without sysfs (some containers) every logical CPU counts as its own core
+		ReadSysfsNumber(Cpu, "core_id", Entry.CoreId);
+		ReadSysfsNumber(Cpu, "physical_package_id", Entry.PackageId);
+		OutTopology.push_back(Entry);
+	}
+}
+
+bool LinuxPlatformProcess::SetThreadAffinityMask(std::uint64_t Mask)
+{
+	cpu_set_t Set;
+	CPU_ZERO(&Set);
+	for (std::uint32_t Cpu = 0; Cpu < 64; ++Cpu)
+	{
+		if (Mask & (std::uint64_t(1) << Cpu))
+		{
+			CPU_SET(Cpu, &Set);
+		}
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(Set), &Set) == 0;
+}
+
+bool LinuxPlatformProcess::PinCurrentThreadToCpu(std::uint32_t Cpu)
+{
+	if (Cpu >= CPU_SETSIZE)
+	{
+		return false;
+	}
+	cpu_set_t Set;
+	CPU_ZERO(&Set);
+	CPU_SET(Cpu, &Set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(Set), &Set) == 0;
+}
+
+std::uint32_t LinuxPlatformProcess::GetCurrentProcessId()
+{
+	return std::uint32_t(getpid());
+}
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex needs a plain 32-bit word");
+
+bool LinuxPlatformProcess::WaitOnAddress(const std::atomic<std::uint32_t>* Address, std::uint32_t Expected, std::uint32_t TimeoutMs)
+{
+	timespec Timeout;
+	Timeout.tv_sec = TimeoutMs / 1000;
+	Timeout.tv_nsec = long(TimeoutMs % 1000) * 1000000;
+	const long Result = syscall(SYS_futex, Address, FUTEX_WAIT_PRIVATE, Expected, TimeoutMs == InfiniteWait ? nullptr : &Timeout, nullptr, 0);
+	return Result == 0 || errno != ETIMEDOUT;
+}
+
+void LinuxPlatformProcess::WakeOnAddress(const std::atomic<std::uint32_t>* Address, bool bWakeAll)
+{
+	syscall(SYS_futex, Address, FUTEX_WAKE_PRIVATE, bWakeAll ? INT_MAX : 1, nullptr, nullptr, 0);
+}
+
+#endif // PLATFORM_LINUX
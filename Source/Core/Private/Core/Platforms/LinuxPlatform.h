@@ -0,0 +1,164 @@
+/*================================================================================
+	LinuxPlatform.h: Setup for the Linux platform
+==================================================================================*/
+
+#pragma once
+#include <limits.h>
+
+/**
+* Linux specific types
+**/
+struct LinuxPlatformTypes : public GenericPlatformTypes
+{
+	typedef unsigned int		DWORD;
+	typedef size_t				SIZE_T;
+	typedef decltype(NULL)		TYPE_OF_NULL;
+	typedef char16_t			CHAR16;
+};
+
+typedef LinuxPlatformTypes PlatformTypes;
+
+#if !defined(COMPILER_GNU) && defined(__GNUC__)
+#define COMPILER_GNU					1
+#endif
+
+// Base defines, must define these for the platform, there are no defaults
+#define PLATFORM_DESKTOP				1
+#if defined(__LP64__)
+#define PLATFORM_64BITS					1
+#else
+#define PLATFORM_64BITS					0
+#endif
+#define PLATFORM_CAN_SUPPORT_EDITORONLY_DATA	1
+
+// Base defines, defaults are commented out
+
+#define PLATFORM_LITTLE_ENDIAN						(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define PLATFORM_SUPPORTS_PRAGMA_PACK				1
+#if defined(__x86_64__) || defined(__i386__)
+#define PLATFORM_ENABLE_VECTORINTRINSICS			1
+#endif
+#define PLATFORM_USE_SYSTEM_VSWPRINTF				0
+#define PLATFORM_COMPILER_DISTINGUISHES_INT_AND_LONG			1
+#define PLATFORM_TCHAR_IS_4_BYTES					1
+#define PLATFORM_HAS_BSD_TIME						1
+#define PLATFORM_USE_PTHREADS						1
+#define PLATFORM_MAX_FILEPATH_LENGTH				PATH_MAX
+#define PLATFORM_SUPPORTS_STACK_SYMBOLS				1
+#define PLATFORM_CACHE_LINE_SIZE					64
+
+// Function type macros.
+#define VARARGS																		/* Functions with variable arguments */
+#define CDECL																		/* Standard C function */
+#define STDCALL																		/* Standard calling convention */
+#define FORCEINLINE inline __attribute__ ((always_inline))							/* Force code to be inline */
+#define FORCENOINLINE __attribute__((noinline))										/* Force code to NOT be inline */
+#define FUNCTION_CHECK_RETURN(...) __attribute__ ((warn_unused_result))	__VA_ARGS__	/* Wrap a function signature in this to warn that callers should not ignore the return value. */
+
+// Branch and cache hints.
+#define LIKELY(x)			__builtin_expect(!!(x), 1)
+#define UNLIKELY(x)			__builtin_expect(!!(x), 0)
+#define PREFETCH(p)			__builtin_prefetch((p), 0, 3)					/* Prefetch for reading */
+#define PREFETCH_WRITE(p)	__builtin_prefetch((p), 1, 3)					/* Prefetch for writing */
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_PAUSE()			__builtin_ia32_pause()							/* Spin wait hint */
+#elif defined(__aarch64__)
+#define CPU_PAUSE()			__asm__ __volatile__("yield")
+#endif
+
+#define TEXT_HELPER(a,b)	a ## b
+#define TEXT(s)				TEXT_HELPER(L, s)
+
+// Alignment.
+#define GCC_PACK(n) __attribute__((packed,aligned(n)))
+#define GCC_ALIGN(n) __attribute__((aligned(n)))
+
+// operator new/delete operators
+#define OPERATOR_NEW_THROW_SPEC
+#define OPERATOR_DELETE_THROW_SPEC noexcept
+#define OPERATOR_NEW_NOTHROW_SPEC  noexcept
+#define OPERATOR_DELETE_NOTHROW_SPEC  noexcept
+
+#define TRINITY_PATH_MAX PATH_MAX
+#define DECLSPEC_NORETURN
+#define DECLSPEC_DEPRECATED
+
+// DLL export and import definitions
+#define DLLEXPORT __attribute__((visibility("default")))
+#define DLLIMPORT
+
+#define MAX_PATH PATH_MAX
+
+/**
+* Linux memory functions: mmap file views, madvise hints and huge pages
+**/
+struct LinuxPlatformMemory : public GenericPlatformMemory
+{
+	/** Size of a transparent or explicit huge page on x86-64 and most arm64 kernels. */
+	static const std::size_t HugePageSize = 2 * 1024 * 1024;
+
+	static std::size_t GetPageSize();
+
+	/** Maps the file read-only. The view stays valid after the file is closed or replaced. */
+	static bool MapFile(const char* Path, MappedFileView& OutView);
+	static void UnmapFile(MappedFileView& View);
+
+	/** Passes Advice for the pages overlapping [Address, Address + Size) to madvise. */
+	static void Advise(const void* Address, std::size_t Size, EMemoryAdvice Advice);
+
+	/**
+	* Allocates Size bytes rounded up to whole huge pages. Uses reserved huge pages (MAP_HUGETLB)
+	* when the system has them, otherwise asks for transparent huge pages on a normal mapping.
+	* Returns null on failure. Free with FreeLargePages and the same Size.
+	*/
+	static void* AllocateLargePages(std::size_t Size);
+	static void FreeLargePages(void* Address, std::size_t Size);
+
+	/** ru_maxrss from getrusage. */
+	static std::uint64_t GetPeakResidentBytes();
+};
+
+/**
+* Linux timing functions: CLOCK_MONOTONIC and, on x86, the time stamp counter
+**/
+struct LinuxPlatformTime : public GenericPlatformTime
+{
+	static double Seconds();
+
+	/** rdtsc on x86, where the kernel exposes an invariant TSC; CLOCK_MONOTONIC_RAW nanoseconds elsewhere. */
+	static std::uint64_t Cycles64();
+
+	/** Calibrated against CLOCK_MONOTONIC_RAW once, on first use. */
+	static double GetSecondsPerCycle64();
+
+	/** CLOCK_THREAD_CPUTIME_ID and CLOCK_PROCESS_CPUTIME_ID. */
+	static double ThreadCpuSeconds();
+	static double ProcessCpuSeconds();
+};
+
+/**
+* Linux CPU topology from sysfs and thread affinity through pthreads
+**/
+struct LinuxPlatformProcess : public GenericPlatformProcess
+{
+	/** Logical CPUs in this process' affinity mask, which honors taskset and cgroup cpusets. */
+	static std::uint32_t NumberOfCoresIncludingHyperthreads();
+
+	/** Distinct physical cores among NumberOfCoresIncludingHyperthreads. */
+	static std::uint32_t NumberOfCores();
+
+	static void GetCpuTopology(std::vector<CpuTopologyEntry>& OutTopology);
+
+	static bool SetThreadAffinityMask(std::uint64_t Mask);
+	static bool PinCurrentThreadToCpu(std::uint32_t Cpu);
+
+	static std::uint32_t GetCurrentProcessId();
+
+	/** futex(FUTEX_WAIT_PRIVATE), the kernel checks *Address against Expected atomically. */
+	static bool WaitOnAddress(const std::atomic<std::uint32_t>* Address, std::uint32_t Expected, std::uint32_t TimeoutMs = InfiniteWait);
+	static void WakeOnAddress(const std::atomic<std::uint32_t>* Address, bool bWakeAll = false);
+};
+
+typedef LinuxPlatformMemory PlatformMemory;
+typedef LinuxPlatformTime PlatformTime;
+typedef LinuxPlatformProcess PlatformProcess;
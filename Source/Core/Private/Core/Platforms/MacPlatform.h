@@ -18,6 +18,9 @@ struct MacPlatformTypes : public GenericPlatformTypes
 };
 
 typedef MacPlatformTypes PlatformTypes;
+typedef GenericPlatformMemory PlatformMemory;
+typedef GenericPlatformTime PlatformTime;
+typedef GenericPlatformProcess PlatformProcess;
 
 // Base defines, must define these for the platform, there are no defaults
 #define PLATFORM_DESKTOP				1
@@ -0,0 +1,14 @@
+#if PLATFORM_WINDOWS
+
+#include <process.h>
+
+/*-----------------------------------------------------------------------------
+	WindowsPlatformProcess
+-----------------------------------------------------------------------------*/
+
+std::uint32_t WindowsPlatformProcess::GetCurrentProcessId()
+{
+	return std::uint32_t(_getpid());
+}
+
+#endif // PLATFORM_WINDOWS
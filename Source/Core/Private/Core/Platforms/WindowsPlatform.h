@@ -12,7 +12,18 @@ struct WindowsPlatformTypes : public GenericPlatformTypes
 	#endif
 };
 
+/**
+* Windows process functions, the rest of the process layer is generic
+**/
+struct WindowsPlatformProcess : public GenericPlatformProcess
+{
+	static std::uint32_t GetCurrentProcessId();
+};
+
 typedef WindowsPlatformTypes PlatformTypes;
+typedef GenericPlatformMemory PlatformMemory;
+typedef GenericPlatformTime PlatformTime;
+typedef WindowsPlatformProcess PlatformProcess;
 
 // Base defines, must define these for the platform, there are no defaults
 #define PLATFORM_DESKTOP				1
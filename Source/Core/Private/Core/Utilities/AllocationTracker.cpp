@@ -0,0 +1,430 @@
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace
+{
+	const uint32 SitesPerChunk = 256;
+	const uint32 MaxChunks = 64;
+
+	struct SiteCounters
+	{
+		std::atomic<uint64> Allocations;
+		std::atomic<uint64> Frees;
+		std::atomic<uint64> BytesAllocated;
+		std::atomic<uint64> BytesFreed;
+	};
+
+	/**
+	* Counters of one thread. Only the owning thread writes. Tables and chunks come from calloc,
+	* because they are created inside operator new, and tables are linked into a lock-free list
+	* for the same reason. They are kept after their thread exits.
+	*/
+	struct ThreadTable
+	{
+		std::atomic<SiteCounters*> Chunks[MaxChunks];
+		ThreadTable* Next;
+	};
+
+	/** Sits right before every block handed out, Offset bytes after the start of the malloc block. */
+	struct AllocHeader
+	{
+		uint64 Size;
+		uint32 SiteId;
+		uint32 Offset;
+	};
+
+	/** Everything operator new touches is constant initialized, it runs before any constructor. */
+	std::atomic<ThreadTable*> Tables{ nullptr };
+	std::atomic<int64> LiveBytes{ 0 };
+	std::atomic<int64> PeakBytes{ 0 };
+
+	thread_local ThreadTable* LocalTable = nullptr;
+	thread_local uint32 CurrentSiteId = 0;
+
+	struct Registry
+	{
+		std::mutex Mutex;
+		std::vector<const AllocSite*> Sites;	// Sites[Id - 1]
+		std::string DumpPath;
+	};
+
+	/** Never destroyed, memory is still released while static objects are torn down. */
+	Registry& GetRegistry()
+	{
+		static Registry* Instance = new Registry();
+		return *Instance;
+	}
+
+	void SumThreadCounters(const ThreadTable* Table, AllocThreadCounters& Totals)
+	{
+		for (uint32 ChunkIndex = 0; ChunkIndex < MaxChunks; ++ChunkIndex)
+		{
+			const SiteCounters* Chunk = Table->Chunks[ChunkIndex].load(std::memory_order_acquire);
+			for (uint32 Index = 0; Chunk && Index < SitesPerChunk; ++Index)
+			{
+				Totals.Allocations += Chunk[Index].Allocations.load(std::memory_order_relaxed);
+				Totals.Frees += Chunk[Index].Frees.load(std::memory_order_relaxed);
+				Totals.BytesAllocated += Chunk[Index].BytesAllocated.load(std::memory_order_relaxed);
+				Totals.BytesFreed += Chunk[Index].BytesFreed.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void WriteSites(rapidjson::Writer<rapidjson::StringBuffer>& Writer, const std::vector<AllocSiteStats>& Stats, uint32 TopCount)
+	{
+		Writer.StartArray();
+		for (size_t Index = 0; Index < Stats.size() && Index < TopCount; ++Index)
+		{
+			const AllocSiteStats& Each = Stats[Index];
+			Writer.StartObject();
+			Writer.Key("name");
+			Writer.String(Each.Name);
+			if (Each.File)
+			{
+				Writer.Key("file");
+				Writer.String(Each.File);
+				Writer.Key("line");
+				Writer.Int(Each.Line);
+			}
+			Writer.Key("allocations");
+			Writer.Uint64(Each.Allocations);
+			Writer.Key("frees");
+			Writer.Uint64(Each.Frees);
+			Writer.Key("bytesAllocated");
+			Writer.Uint64(Each.BytesAllocated);
+			Writer.Key("bytesFreed");
+			Writer.Uint64(Each.BytesFreed);
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+	}
+
+#if CORE_ALLOC_TRACKING
+	ThreadTable* GetLocalTable()
+	{
+		if (UNLIKELY(!LocalTable))
+		{
+			ThreadTable* Table = static_cast<ThreadTable*>(calloc(1, sizeof(ThreadTable)));
+			if (!Table)
+			{
+				return nullptr;
+			}
+			Table->Next = Tables.load(std::memory_order_relaxed);
+			while (!Tables.compare_exchange_weak(Table->Next, Table, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+			LocalTable = Table;
+		}
+		return LocalTable;
+	}
+
+	SiteCounters* GetLocalCounters(uint32 SiteId)
+	{
+		ThreadTable* Table = GetLocalTable();
+		if (UNLIKELY(!Table || SiteId >= SitesPerChunk * MaxChunks))
+		{
+			return nullptr;
+		}
+
+		std::atomic<SiteCounters*>& Slot = Table->Chunks[SiteId / SitesPerChunk];
+		SiteCounters* Chunk = Slot.load(std::memory_order_relaxed);
+		if (UNLIKELY(!Chunk))
+		{
+			Chunk = static_cast<SiteCounters*>(calloc(SitesPerChunk, sizeof(SiteCounters)));
+			Slot.store(Chunk, std::memory_order_release);
+		}
+		return Chunk ? &Chunk[SiteId % SitesPerChunk] : nullptr;
+	}
+
+	/** Single writer, so a relaxed load and store is enough and avoids a locked instruction. */
+	FORCEINLINE void Add(std::atomic<uint64>& Counter, uint64 Value)
+	{
+		Counter.store(Counter.load(std::memory_order_relaxed) + Value, std::memory_order_relaxed);
+	}
+
+	void DumpAtExit()
+	{
+		AllocationTracker::DumpJson(GetRegistry().DumpPath.c_str());
+	}
+
+	const size_t DefaultAlignment = alignof(std::max_align_t);
+
+	void* TrackedAlloc(size_t Size, size_t Alignment)
+	{
+		const size_t Extra = sizeof(AllocHeader) + (Alignment > DefaultAlignment ? Alignment : 0);
+		if (Size > SIZE_MAX - Extra)
+		{
+			return nullptr;
+		}
+		uint8* Base = static_cast<uint8*>(malloc(Size + Extra));
+		if (!Base)
+		{
+			return nullptr;
+		}
+
+		uint8* User = Base + sizeof(AllocHeader);
+		if (Alignment > DefaultAlignment)
+		{
+			User = reinterpret_cast<uint8*>((reinterpret_cast<uintptr_t>(User) + Alignment - 1) & ~(Alignment - 1));
+		}
+		AllocHeader* Header = reinterpret_cast<AllocHeader*>(User) - 1;
+		Header->Size = Size;
+		Header->SiteId = CurrentSiteId;
+		Header->Offset = static_cast<uint32>(User - Base);
+
+		const int64 Live = LiveBytes.fetch_add(static_cast<int64>(Size), std::memory_order_relaxed) + static_cast<int64>(Size);
+		int64 Peak = PeakBytes.load(std::memory_order_relaxed);
+		while (Live > Peak && !PeakBytes.compare_exchange_weak(Peak, Live, std::memory_order_relaxed))
+		{
+		}
+
+		if (SiteCounters* Counters = GetLocalCounters(Header->SiteId))
+		{
+			Add(Counters->Allocations, 1);
+			Add(Counters->BytesAllocated, Size);
+		}
+		return User;
+	}
+
+	void TrackedFree(void* Pointer)
+	{
+		if (!Pointer)
+		{
+			return;
+		}
+
+		const AllocHeader* Header = static_cast<const AllocHeader*>(Pointer) - 1;
+		LiveBytes.fetch_sub(static_cast<int64>(Header->Size), std::memory_order_relaxed);
+		if (SiteCounters* Counters = GetLocalCounters(Header->SiteId))
+		{
+			Add(Counters->Frees, 1);
+			Add(Counters->BytesFreed, Header->Size);
+		}
+		free(static_cast<uint8*>(Pointer) - Header->Offset);
+	}
+
+	void* TrackedNew(size_t Size, size_t Alignment)
+	{
+		while (true)
+		{
+			if (void* Pointer = TrackedAlloc(Size, Alignment))
+			{
+				return Pointer;
+			}
+			std::new_handler Handler = std::get_new_handler();
+			if (!Handler)
+			{
+				throw std::bad_alloc();
+			}
+			Handler();
+		}
+	}
+
+	void* TrackedNewNoThrow(size_t Size, size_t Alignment)
+	{
+		try
+		{
+			return TrackedNew(Size, Alignment);
+		}
+		catch (...)
+		{
+			return nullptr;
+		}
+	}
+#endif // CORE_ALLOC_TRACKING
+}
+
+#if CORE_ALLOC_TRACKING
+void* operator new(size_t Size) OPERATOR_NEW_THROW_SPEC { return TrackedNew(Size, 0); }
+void* operator new[](size_t Size) OPERATOR_NEW_THROW_SPEC { return TrackedNew(Size, 0); }
+void* operator new(size_t Size, const std::nothrow_t&) OPERATOR_NEW_NOTHROW_SPEC { return TrackedNewNoThrow(Size, 0); }
+void* operator new[](size_t Size, const std::nothrow_t&) OPERATOR_NEW_NOTHROW_SPEC { return TrackedNewNoThrow(Size, 0); }
+void operator delete(void* Pointer) OPERATOR_DELETE_THROW_SPEC { TrackedFree(Pointer); }
+void operator delete[](void* Pointer) OPERATOR_DELETE_THROW_SPEC { TrackedFree(Pointer); }
+void operator delete(void* Pointer, const std::nothrow_t&) OPERATOR_DELETE_NOTHROW_SPEC { TrackedFree(Pointer); }
+void operator delete[](void* Pointer, const std::nothrow_t&) OPERATOR_DELETE_NOTHROW_SPEC { TrackedFree(Pointer); }
+void operator delete(void* Pointer, size_t) OPERATOR_DELETE_THROW_SPEC { TrackedFree(Pointer); }
+void operator delete[](void* Pointer, size_t) OPERATOR_DELETE_THROW_SPEC { TrackedFree(Pointer); }
+
+#if defined(__cpp_aligned_new)
+void* operator new(size_t Size, std::align_val_t Alignment) OPERATOR_NEW_THROW_SPEC { return TrackedNew(Size, static_cast<size_t>(Alignment)); }
+void* operator new[](size_t Size, std::align_val_t Alignment) OPERATOR_NEW_THROW_SPEC { return TrackedNew(Size, static_cast<size_t>(Alignment)); }
+void* operator new(size_t Size, std::align_val_t Alignment, const std::nothrow_t&) OPERATOR_NEW_NOTHROW_SPEC { return TrackedNewNoThrow(Size, static_cast<size_t>(Alignment)); }
+void* operator new[](size_t Size, std::align_val_t Alignment, const std::nothrow_t&) OPERATOR_NEW_NOTHROW_SPEC { return TrackedNewNoThrow(Size, static_cast<size_t>(Alignment)); }
+void operator delete(void* Pointer, std::align_val_t) OPERATOR_DELETE_THROW_SPEC { TrackedFree(Pointer); }
+void operator delete[](void* Pointer, std::align_val_t) OPERATOR_DELETE_THROW_SPEC { TrackedFree(Pointer); }
+void operator delete(void* Pointer, std::align_val_t, const std::nothrow_t&) OPERATOR_DELETE_NOTHROW_SPEC { TrackedFree(Pointer); }
+void operator delete[](void* Pointer, std::align_val_t, const std::nothrow_t&) OPERATOR_DELETE_NOTHROW_SPEC { TrackedFree(Pointer); }
+void operator delete(void* Pointer, size_t, std::align_val_t) OPERATOR_DELETE_THROW_SPEC { TrackedFree(Pointer); }
+void operator delete[](void* Pointer, size_t, std::align_val_t) OPERATOR_DELETE_THROW_SPEC { TrackedFree(Pointer); }
+#endif
+#endif // CORE_ALLOC_TRACKING
+
+AllocSite::AllocSite(const char* InFile, int32 InLine, const char* InName)
+	: File(InFile)
+	, Line(InLine)
+	, Name(InName)
+{
+	Registry& Reg = GetRegistry();
+	std::lock_guard<std::mutex> Lock(Reg.Mutex);
+	Reg.Sites.push_back(this);
+	Id = static_cast<uint32>(Reg.Sites.size());
+}
+
+int64 AllocationTracker::GetLiveBytes()
+{
+	return LiveBytes.load(std::memory_order_relaxed);
+}
+
+int64 AllocationTracker::GetPeakBytes()
+{
+	return PeakBytes.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::ResetPeak()
+{
+	PeakBytes.store(LiveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void AllocationTracker::GetThreadCounters(AllocThreadCounters& OutCounters)
+{
+	OutCounters = AllocThreadCounters();
+	if (LocalTable)
+	{
+		SumThreadCounters(LocalTable, OutCounters);
+	}
+}
+
+void AllocationTracker::Collect(std::vector<AllocSiteStats>& OutStats)
+{
+	Registry& Reg = GetRegistry();
+	std::lock_guard<std::mutex> Lock(Reg.Mutex);
+	const std::vector<const AllocSite*>& Sites = Reg.Sites;
+
+	// id 0 collects the allocations made outside any scope
+	const uint32 NumIds = static_cast<uint32>(std::min<size_t>(Sites.size() + 1, SitesPerChunk * MaxChunks));
+	std::vector<AllocSiteStats> Totals(NumIds, AllocSiteStats());
+	for (const ThreadTable* Table = Tables.load(std::memory_order_acquire); Table; Table = Table->Next)
+	{
+		for (uint32 Id = 0; Id < NumIds; ++Id)
+		{
+			const SiteCounters* Chunk = Table->Chunks[Id / SitesPerChunk].load(std::memory_order_acquire);
+			if (!Chunk)
+			{
+				Id += SitesPerChunk - 1 - Id % SitesPerChunk;
+				continue;
+			}
+			const SiteCounters& Counters = Chunk[Id % SitesPerChunk];
+			Totals[Id].Allocations += Counters.Allocations.load(std::memory_order_relaxed);
+			Totals[Id].Frees += Counters.Frees.load(std::memory_order_relaxed);
+			Totals[Id].BytesAllocated += Counters.BytesAllocated.load(std::memory_order_relaxed);
+			Totals[Id].BytesFreed += Counters.BytesFreed.load(std::memory_order_relaxed);
+		}
+	}
+
+	OutStats.clear();
+	for (uint32 Id = 0; Id < NumIds; ++Id)
+	{
+		AllocSiteStats& Each = Totals[Id];
+		if (!Each.Allocations && !Each.Frees)
+		{
+			continue;
+		}
+		const AllocSite* Site = Id ? Sites[Id - 1] : nullptr;
+		Each.Name = Site ? Site->Name : "<untagged>";
+		Each.File = Site ? Site->File : nullptr;
+		Each.Line = Site ? Site->Line : 0;
+		OutStats.push_back(Each);
+	}
+}
+
+void AllocationTracker::WriteJson(std::string& OutJson, uint32 TopCount)
+{
+	std::vector<AllocSiteStats> Stats;
+	Collect(Stats);
+
+	AllocThreadCounters Totals = AllocThreadCounters();
+	for (const AllocSiteStats& Each : Stats)
+	{
+		Totals.Allocations += Each.Allocations;
+		Totals.Frees += Each.Frees;
+		Totals.BytesAllocated += Each.BytesAllocated;
+		Totals.BytesFreed += Each.BytesFreed;
+	}
+
+	rapidjson::StringBuffer Buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> Writer(Buffer);
+	Writer.StartObject();
+	Writer.Key("enabled");
+	Writer.Bool(IsEnabled());
+	Writer.Key("liveBytes");
+	Writer.Int64(GetLiveBytes());
+	Writer.Key("peakBytes");
+	Writer.Int64(GetPeakBytes());
+	Writer.Key("allocations");
+	Writer.Uint64(Totals.Allocations);
+	Writer.Key("frees");
+	Writer.Uint64(Totals.Frees);
+	Writer.Key("bytesAllocated");
+	Writer.Uint64(Totals.BytesAllocated);
+	Writer.Key("bytesFreed");
+	Writer.Uint64(Totals.BytesFreed);
+
+	std::sort(Stats.begin(), Stats.end(), [](const AllocSiteStats& A, const AllocSiteStats& B) { return A.BytesAllocated > B.BytesAllocated; });
+	Writer.Key("topByBytes");
+	WriteSites(Writer, Stats, TopCount);
+
+	std::sort(Stats.begin(), Stats.end(), [](const AllocSiteStats& A, const AllocSiteStats& B) { return A.Allocations > B.Allocations; });
+	Writer.Key("topByCount");
+	WriteSites(Writer, Stats, TopCount);
+
+	Writer.EndObject();
+	OutJson.assign(Buffer.GetString(), Buffer.GetSize());
+}
+
+bool AllocationTracker::DumpJson(const char* Path)
+{
+	std::string Json;
+	WriteJson(Json);
+
+	FILE* File = fopen(Path, "wb");
+	if (!File)
+	{
+		return false;
+	}
+	const bool bWritten = fwrite(Json.data(), 1, Json.size(), File) == Json.size();
+	return fclose(File) == 0 && bWritten;
+}
+
+#if CORE_ALLOC_TRACKING
+void AllocationTracker::DumpOnExit(const char* Path)
+{
+	Registry& Reg = GetRegistry();
+	bool bFirstCall;
+	{
+		std::lock_guard<std::mutex> Lock(Reg.Mutex);
+		bFirstCall = Reg.DumpPath.empty();
+		Reg.DumpPath = Path;
+	}
+	if (bFirstCall)
+	{
+		atexit(&DumpAtExit);
+	}
+}
+#else
+void AllocationTracker::DumpOnExit(const char* /*Path*/)
+{
+}
+#endif // CORE_ALLOC_TRACKING
+
+uint32 AllocationTracker::EnterScope(const AllocSite& Site)
+{
+	const uint32 Previous = CurrentSiteId;
+	CurrentSiteId = Site.Id;
+	return Previous;
+}
+
+void AllocationTracker::LeaveScope(uint32 PreviousSiteId)
+{
+	CurrentSiteId = PreviousSiteId;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+/**
+* Allocation tracking, compiled in with CORE_ALLOC_TRACKING=1 (off by default).
+* Core then replaces the global operator new and delete. Every allocation carries a small header
+* with its size and the innermost ALLOC_SCOPE that was active when it was made. Counters are kept
+* per thread and per scope, in tables only their own thread writes, and are summed up on demand.
+* The live byte count and its high-water mark are process wide.
+* A free is charged to the scope the memory was allocated in, whichever thread releases it.
+*/
+#ifndef CORE_ALLOC_TRACKING
+#define CORE_ALLOC_TRACKING 0
+#endif
+
+/**
+* A named region of code that allocations are attributed to
+**/
+struct Core_API AllocSite
+{
+	AllocSite(const char* InFile, int32 InLine, const char* InName);
+
+	const char* File;
+	int32 Line;
+	const char* Name;
+	uint32 Id;			// 0 is reserved for allocations outside any scope
+};
+
+/**
+* Totals for one AllocSite, see AllocationTracker::Collect
+**/
+struct AllocSiteStats
+{
+	const char* Name;
+	const char* File;	// null for allocations outside any scope
+	int32 Line;
+	uint64 Allocations;
+	uint64 Frees;
+	uint64 BytesAllocated;
+	uint64 BytesFreed;
+};
+
+/**
+* Allocation counters of one thread
+**/
+struct AllocThreadCounters
+{
+	uint64 Allocations;
+	uint64 Frees;
+	uint64 BytesAllocated;
+	uint64 BytesFreed;
+};
+
+class Core_API AllocationTracker
+{
+public:
+	static bool IsEnabled()
+	{
+		return CORE_ALLOC_TRACKING != 0;
+	}
+
+	/** Bytes currently allocated through operator new. */
+	static int64 GetLiveBytes();
+
+	/** High-water mark of GetLiveBytes since start or the last ResetPeak. */
+	static int64 GetPeakBytes();
+	static void ResetPeak();
+
+	/** Counters of the calling thread, over all scopes. */
+	static void GetThreadCounters(AllocThreadCounters& OutCounters);
+
+	/** Sums the tables of all threads, one entry per site that saw any allocation. */
+	static void Collect(std::vector<AllocSiteStats>& OutStats);
+
+	/** Writes live and peak bytes and the TopCount sites by bytes allocated and by allocation count. */
+	static void WriteJson(std::string& OutJson, uint32 TopCount = 20);
+
+	/** Writes the JSON to Path. Returns false if the file cannot be written. */
+	static bool DumpJson(const char* Path);
+
+	/** Dumps the JSON to Path when the process exits. Does nothing unless CORE_ALLOC_TRACKING is enabled. */
+	static void DumpOnExit(const char* Path);
+
+	/** Makes Site the scope of the calling thread's allocations and returns the previous one. */
+	static uint32 EnterScope(const AllocSite& Site);
+	static void LeaveScope(uint32 PreviousSiteId);
+};
+
+#if CORE_ALLOC_TRACKING
+
+class ScopedAllocTag
+{
+public:
+	explicit ScopedAllocTag(const AllocSite& Site)
+		: PreviousSiteId(AllocationTracker::EnterScope(Site))
+	{
+	}
+
+	~ScopedAllocTag()
+	{
+		AllocationTracker::LeaveScope(PreviousSiteId);
+	}
+
+	DISABLE_COPY_AND_ASSIGN(ScopedAllocTag);
+
+private:
+	uint32 PreviousSiteId;
+};
+
+#define ALLOC_SCOPE(Name) static const AllocSite STR_CONCAT(allocSite, __LINE__)(__FILE__, __LINE__, Name); \
+	ScopedAllocTag STR_CONCAT(allocScope, __LINE__)(STR_CONCAT(allocSite, __LINE__))
+
+#else
+
+#define ALLOC_SCOPE(Name)
+
+#endif // CORE_ALLOC_TRACKING
@@ -93,55 +93,49 @@ void AbortHandler(int /*sigval*/)
 	exit(1);
 }
 
+// constexpr constructors, so these are constant initialized
 const Status Status::OK = Status();
-const Status Status::FAILED = Status(EStatusCode::FAILED, "FAILED");
-const Status Status::UNKNOWN = Status(EStatusCode::UNKNOWN, "UNKNOWN");
+const Status Status::FAILED = Status(Status::EStatusCode::FAILED, "FAILED");
+const Status Status::UNKNOWN = Status(Status::EStatusCode::UNKNOWN, "UNKNOWN");
 
-
-Status::Status() : StatusCode(EStatusCode::OK)
-{
-}
-
-Status::Status(EStatusCode statusCode, std::string errorMessage)
-	: StatusCode(statusCode)
+namespace
 {
-	if (StatusCode != EStatusCode::OK) {
-		ErrorMessage = errorMessage;
+	/** Never destroyed, statuses holding interned messages may live in other static objects. */
+	const char* InternMessage(const std::string& message)
+	{
+		static std::mutex* Mutex = new std::mutex();
+		static std::unordered_set<std::string>* Messages = new std::unordered_set<std::string>();
+		std::lock_guard<std::mutex> Lock(*Mutex);
+		return Messages->insert(message).first->c_str();
 	}
 }
 
-Status::Status(const Status& other)
-	: StatusCode(other.StatusCode), ErrorMessage(other.ErrorMessage)
+Status::Status(EStatusCode statusCode, const std::string& errorMessage)
+	: StatusCode(statusCode)
+	, ErrorMessage(statusCode == EStatusCode::OK || errorMessage.empty() ? nullptr : InternMessage(errorMessage))
 {
 }
 
-Status& Status::operator=(const Status& other)
-{
-	StatusCode = other.StatusCode;
-	ErrorMessage = other.ErrorMessage;
-	return *this;
-}
-
 bool Status::operator==(const Status& x) const
 {
-	return (StatusCode == x.StatusCode) &&
-		(ErrorMessage == x.ErrorMessage);
+	if (StatusCode != x.StatusCode) {
+		return false;
+	}
+	if (ErrorMessage == x.ErrorMessage) {
+		return true;
+	}
+	return ErrorMessage && x.ErrorMessage && strcmp(ErrorMessage, x.ErrorMessage) == 0;
 }
 
 Status& Status::operator<<(const Status& other)
 {
-	// TODO: Finish this
-	/*
-	if (other.StatusCode != EStatusCode::OK)
-	{
+	if (IsOk()) {
+		*this = other;
 	}
-	*/
 	return *this;
 }
 
-
-
-inline std::string Status::StatusCodeEnumToString(EStatusCode code) const
+const char* Status::StatusCodeEnumToString(EStatusCode code)
 {
 	switch (code) {
 	case EStatusCode::OK:
@@ -151,20 +145,15 @@ inline std::string Status::StatusCodeEnumToString(EStatusCode code) const
 	case EStatusCode::UNKNOWN:
 		return "UNKNOWN";
 	}
+	return "UNKNOWN";
 }
 
 std::string Status::ToString() const
 {
-	if (StatusCode == EStatusCode::OK) {
-		return "OK";
+	std::string result = StatusCodeEnumToString(StatusCode);
+	if (ErrorMessage && *ErrorMessage) {
+		result += ":";
+		result += ErrorMessage;
 	}
-	else {
-		if (ErrorMessage.empty()) {
-			return StatusCodeEnumToString(StatusCode);
-		}
-		else {
-			return StatusCodeEnumToString(StatusCode) + ":" +
-				ErrorMessage;
-		}
-	}
-}
\ No newline at end of file
+	return result;
+}
@@ -54,30 +54,54 @@ template <typename T> inline T* ASSERT_NOTNULL(T* pointer)
 	return pointer;
 }
 
-class Status
+/**
+* Result of an operation: a code and an optional message.
+* Trivially copyable and two words wide. The SysV x86-64 and AArch64 ABIs return it in a register
+* pair, so there success costs no more than returning an integer. Win64 returns every struct wider
+* than 8 bytes through a hidden pointer, so on Windows it is a store and a load into the caller's
+* frame instead. The message is a pointer that must outlive the status: a string
+* literal, or a run time string that the std::string constructor interns once per distinct value.
+* Text is only put together when ToString is called.
+**/
+class Core_API Status
 {
-private:
-	enum class EStatusCode {
+public:
+	enum class EStatusCode : uint32 {
 		OK = 0,
 		FAILED = 1,
 		UNKNOWN = 2
 	};
 
-	EStatusCode StatusCode;
-	std::string ErrorMessage;
+	constexpr Status()
+		: StatusCode(EStatusCode::OK), ErrorMessage(nullptr)
+	{
+	}
 
-	inline std::string StatusCodeEnumToString(EStatusCode code) const;
+	constexpr Status(EStatusCode statusCode, const char* errorMessage = nullptr)
+		: StatusCode(statusCode), ErrorMessage(statusCode == EStatusCode::OK ? nullptr : errorMessage)
+	{
+	}
 
-public:
+	/**
+	* Interns errorMessage, meant for failures that format their message at run time.
+	* Every distinct message is kept until the process exits, so keep ids, paths and other
+	* unbounded values out of messages created in a loop.
+	*/
+	Status(EStatusCode statusCode, const std::string& errorMessage);
 
+	bool IsOk() const {
+		return StatusCode == EStatusCode::OK;
+	}
+	EStatusCode GetCode() const {
+		return StatusCode;
+	}
+	/** Null when there is no message. */
+	const char* GetErrorMessage() const {
+		return ErrorMessage;
+	}
 
-	Status();
-	Status(EStatusCode statusCode, std::string errorMessage);
-	Status(const Status& other);
-	
 	std::string ToString() const;
 
-	Status& operator=(const Status& other);
 	bool operator==(const Status& x) const;
 	bool operator!=(const Status& x) const {
 		return !operator==(x);
@@ -87,6 +111,15 @@ public:
 	static const Status FAILED;
 	static const Status UNKNOWN;
 
+	/** Keeps the first failure: takes other over only while this status is still OK. */
 	Status& operator<<(const Status& other);
+
+private:
+	static const char* StatusCodeEnumToString(EStatusCode code);
+
+	EStatusCode StatusCode;
+	const char* ErrorMessage;
 };
+static_assert(std::is_trivially_copyable<Status>::value, "Status is returned by value from hot paths and must stay trivially copyable");
+static_assert(sizeof(Status) <= 2 * sizeof(void*), "Status must fit a register pair to be returned in registers on SysV");
 typedef Status SC;
\ No newline at end of file
@@ -0,0 +1,199 @@
+#pragma once
+
+/**
+* Bounded multi producer, multi consumer queue (Dmitry Vyukov's array based design).
+* Every cell carries a sequence number that tells whose turn it is: a producer may fill the cell
+* for position Pos once its sequence equals Pos, a consumer may empty it once it equals Pos + 1.
+* Producers and consumers each advance their own counter with a compare-exchange, so the only
+* contention is between threads on the same side, and no locks are taken.
+* Items are moved in and out. Capacity is rounded up to a power of two.
+* TryPush and TryPop never block; blocking is left to the caller, see ProducerConsumerQueue.
+*/
+template<typename T>
+class MPMCRingBuffer
+{
+	struct Cell
+	{
+		std::atomic<size_t> Sequence;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+		T* Item()
+		{
+			return reinterpret_cast<T*>(&Storage);
+		}
+	};
+
+public:
+	explicit MPMCRingBuffer(size_t InCapacity)
+	{
+		size_t RoundedCapacity = 2;
+		while (RoundedCapacity < InCapacity)
+		{
+			RoundedCapacity *= 2;
+		}
+
+		Mask = RoundedCapacity - 1;
+		Cells = new Cell[RoundedCapacity];
+		for (size_t Index = 0; Index < RoundedCapacity; ++Index)
+		{
+			Cells[Index].Sequence.store(Index, std::memory_order_relaxed);
+		}
+		EnqueuePos.store(0, std::memory_order_relaxed);
+		DequeuePos.store(0, std::memory_order_relaxed);
+	}
+
+	~MPMCRingBuffer()
+	{
+		const size_t End = EnqueuePos.load(std::memory_order_relaxed);
+		for (size_t Pos = DequeuePos.load(std::memory_order_relaxed); Pos != End; ++Pos)
+		{
+			Cells[Pos & Mask].Item()->~T();
+		}
+		delete[] Cells;
+	}
+
+	DISABLE_COPY_AND_ASSIGN(MPMCRingBuffer);
+
+	size_t Capacity() const
+	{
+		return Mask + 1;
+	}
+
+	/** Returns false if the buffer is full; Item is left untouched then. */
+	bool TryPush(T&& Item)
+	{
+		return PushBulk(std::make_move_iterator(&Item), 1) == 1;
+	}
+
+	bool TryPush(const T& Item)
+	{
+		return PushBulk(&Item, 1) == 1;
+	}
+
+	/** Returns false if the buffer is empty. */
+	bool TryPop(T& OutItem)
+	{
+		return PopBulk(&OutItem, 1) == 1;
+	}
+
+	/**
+	* Pushes up to Count items read from First, claiming all the cells with a single
+	* compare-exchange. Items are moved when First is a move iterator.
+	* Returns how many were pushed, fewer than Count when the buffer fills up.
+	*/
+	template<typename InputIt>
+	size_t PushBulk(InputIt First, size_t Count)
+	{
+		if (Count == 0)
+		{
+			// nothing to claim, the ready check below would retry forever
+			return 0;
+		}
+
+		size_t Pos = EnqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			const size_t Claimable = CountCells(Pos, Count, 0);
+			if (Claimable == 0)
+			{
+				const intptr_t Difference = intptr_t(Cells[Pos & Mask].Sequence.load(std::memory_order_acquire)) - intptr_t(Pos);
+				if (Difference < 0)
+				{
+					// full, the consumer one lap behind has not emptied this cell yet
+					return 0;
+				}
+				Pos = EnqueuePos.load(std::memory_order_relaxed);
+				continue;
+			}
+
+			if (EnqueuePos.compare_exchange_weak(Pos, Pos + Claimable, std::memory_order_relaxed))
+			{
+				for (size_t Index = 0; Index < Claimable; ++Index, ++First)
+				{
+					Cell& Target = Cells[(Pos + Index) & Mask];
+					new (Target.Item()) T(*First);
+					Target.Sequence.store(Pos + Index + 1, std::memory_order_release);
+				}
+				return Claimable;
+			}
+		}
+	}
+
+	/**
+	* Moves up to MaxCount items into Out, claiming all the cells with a single compare-exchange.
+	* Returns how many were popped, 0 if the buffer is empty.
+	*/
+	template<typename OutputIt>
+	size_t PopBulk(OutputIt Out, size_t MaxCount)
+	{
+		if (MaxCount == 0)
+		{
+			return 0;
+		}
+
+		size_t Pos = DequeuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			const size_t Claimable = CountCells(Pos, MaxCount, 1);
+			if (Claimable == 0)
+			{
+				const intptr_t Difference = intptr_t(Cells[Pos & Mask].Sequence.load(std::memory_order_acquire)) - intptr_t(Pos + 1);
+				if (Difference < 0)
+				{
+					// empty, the producer for this position has not finished writing
+					return 0;
+				}
+				Pos = DequeuePos.load(std::memory_order_relaxed);
+				continue;
+			}
+
+			if (DequeuePos.compare_exchange_weak(Pos, Pos + Claimable, std::memory_order_relaxed))
+			{
+				for (size_t Index = 0; Index < Claimable; ++Index, ++Out)
+				{
+					Cell& Source = Cells[(Pos + Index) & Mask];
+					T* Item = Source.Item();
+					*Out = std::move(*Item);
+					Item->~T();
+					Source.Sequence.store(Pos + Index + Mask + 1, std::memory_order_release);
+				}
+				return Claimable;
+			}
+		}
+	}
+
+	/** Approximate unless the buffer is quiescent. */
+	size_t Size() const
+	{
+		const size_t Dequeued = DequeuePos.load(std::memory_order_relaxed);
+		const size_t Enqueued = EnqueuePos.load(std::memory_order_relaxed);
+		return Enqueued > Dequeued ? Enqueued - Dequeued : 0;
+	}
+
+	bool IsEmpty() const
+	{
+		return Size() == 0;
+	}
+
+private:
+	/**
+	* Number of consecutive cells from Pos, at most Limit, whose sequence equals their position
+	* plus Offset, i.e. that are ready for this side. The claim on them is made by the caller.
+	*/
+	size_t CountCells(size_t Pos, size_t Limit, size_t Offset) const
+	{
+		size_t Count = 0;
+		while (Count < Limit && Count <= Mask
+			&& Cells[(Pos + Count) & Mask].Sequence.load(std::memory_order_acquire) == Pos + Count + Offset)
+		{
+			++Count;
+		}
+		return Count;
+	}
+
+	Cell* Cells;
+	size_t Mask;
+
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<size_t> EnqueuePos;
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<size_t> DequeuePos;
+};
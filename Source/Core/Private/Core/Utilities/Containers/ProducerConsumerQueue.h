@@ -16,87 +16,259 @@
 */
 #pragma once
 
+/**
+* Outcome of the blocking pops of ProducerConsumerQueue
+*/
+enum class EQueueWaitResult
+{
+	Popped,		// at least one item was taken, or none when a bulk pop asked for 0
+	TimedOut,	// the timeout passed with the queue still empty
+	Shutdown	// the queue was cancelled
+};
+
+/**
+* Blocking queue between producer and consumer threads, a facade over MPMCRingBuffer.
+* Push and Pop never take a lock. Waiting threads spin briefly and then sleep on a futex style
+* word (PlatformProcess::WaitOnAddress). A producer only makes a wake up call when a consumer is
+* actually asleep. Unlike the std::queue it replaced the queue is bounded: Push blocks while it is
+* full, TryPush fails instead.
+*/
 template <typename T>
 class ProducerConsumerQueue
 {
 private:
-	std::mutex _queueLock;
-	std::queue<T> _queue;
-	std::condition_variable _condition;
+	static const int SpinCount = 64;
+
+	MPMCRingBuffer<T> _queue;
 	std::atomic<bool> _shutdown;
 
+	// bumped whenever items are pushed (popped) while a consumer (producer) sleeps
+	std::atomic<uint32> _pushEpoch;
+	std::atomic<uint32> _popEpoch;
+	std::atomic<int32> _sleepingConsumers;
+	std::atomic<int32> _sleepingProducers;
+
 public:
 
-	ProducerConsumerQueue<T>() : 
-		_shutdown(false)
+	/**
+	* Holds at most capacity items (rounded up to a power of two). Push waits for a consumer to make
+	* room, so a thread that fills the queue before it pops from it itself must size the queue for
+	* everything it pushes, or use TryPush.
+	*/
+	explicit ProducerConsumerQueue<T>(size_t capacity = 1024) :
+		_queue(capacity),
+		_shutdown(false),
+		_pushEpoch(0),
+		_popEpoch(0),
+		_sleepingConsumers(0),
+		_sleepingProducers(0)
 	{
 	}
 
 	void Push(const T& value)
 	{
-		std::lock_guard<std::mutex> lock(_queueLock);
-		_queue.push(std::move(value));
+		T copy(value);
+		Push(std::move(copy));
+	}
 
-		_condition.notify_one();
+	void Push(T&& value)
+	{
+		PushBulk(std::make_move_iterator(&value), 1);
 	}
 
-	bool Empty()
+	/** Returns false if the queue is full or cancelled, value is left with the caller then. */
+	bool TryPush(T&& value)
 	{
-		std::lock_guard<std::mutex> lock(_queueLock);
+		if (_shutdown || !_queue.TryPush(std::move(value)))
+			return false;
 
-		return _queue.empty();
+		Notify(_pushEpoch, _sleepingConsumers, false);
+		return true;
 	}
 
-	bool Pop(T& value)
+	bool TryPush(const T& value)
 	{
-		std::lock_guard<std::mutex> lock(_queueLock);
-
-		if (_queue.empty() || _shutdown)
+		if (_shutdown || !_queue.TryPush(value))
 			return false;
 
-		value = _queue.front();
+		Notify(_pushEpoch, _sleepingConsumers, false);
+		return true;
+	}
 
-		_queue.pop();
+	/** Pushes count items read from first, blocking while the queue is full. */
+	template<typename ForwardIt>
+	void PushBulk(ForwardIt first, size_t count)
+	{
+		LOCK_STATS_WAIT_SCOPE(pushWait, "ProducerConsumerQueue::Push");
+		int spins = 0;
+		while (count)
+		{
+			if (_shutdown)
+			{
+				for (; count; --count, ++first)
+				{
+					T dropped(*first);
+					DeleteQueuedObject(dropped);
+				}
+				return;
+			}
 
-		return true;
+			const size_t pushed = _queue.PushBulk(first, count);
+			if (pushed)
+			{
+				std::advance(first, pushed);
+				count -= pushed;
+				spins = 0;
+				Notify(_pushEpoch, _sleepingConsumers, pushed > 1);
+				continue;
+			}
+
+			LOCK_STATS_WAITING(pushWait);
+			WaitFor(_popEpoch, _sleepingProducers, spins, [this]() { return _queue.Size() < _queue.Capacity(); });
+		}
 	}
 
-	void WaitAndPop(T& value)
+	bool Empty()
 	{
-		std::unique_lock<std::mutex> lock(_queueLock);
+		return _queue.IsEmpty();
+	}
 
-		// we could be using .wait(lock, predicate) overload here but it is broken
-		// https://connect.microsoft.com/VisualStudio/feedback/details/1098841
-		while (_queue.empty() && !_shutdown)
-			_condition.wait(lock);
+	bool Pop(T& value)
+	{
+		if (_shutdown || !_queue.TryPop(value))
+			return false;
 
-		if (_queue.empty() || _shutdown)
-			return;
+		Notify(_popEpoch, _sleepingProducers, false);
+		return true;
+	}
+
+	/** Blocks until an item arrives or the queue is cancelled. */
+	EQueueWaitResult WaitAndPop(T& value)
+	{
+		size_t popped;
+		return WaitAndPopInternal(&value, 1, popped, PlatformProcess::InfiniteWait);
+	}
+
+	/** Like WaitAndPop, but gives up with TimedOut once timeout has passed. */
+	template<typename Rep, typename Period>
+	EQueueWaitResult WaitAndPopFor(T& value, const std::chrono::duration<Rep, Period>& timeout)
+	{
+		size_t popped;
+		return WaitAndPopInternal(&value, 1, popped, TimeoutToMilliseconds(timeout));
+	}
 
-		value = _queue.front();
+	/**
+	* Blocks until at least one item is available, then moves up to maxCount items into out in
+	* one go, so a busy consumer pays for one wake up per batch instead of per item.
+	* Returns the number of items popped, 0 only when the queue was cancelled or maxCount is 0.
+	*/
+	template<typename OutputIt>
+	size_t WaitAndPopBulk(OutputIt out, size_t maxCount)
+	{
+		size_t popped = 0;
+		WaitAndPopInternal(out, maxCount, popped, PlatformProcess::InfiniteWait);
+		return popped;
+	}
 
-		_queue.pop();
+	/** WaitAndPopBulk with a timeout, the number of items popped is returned in outCount. */
+	template<typename OutputIt, typename Rep, typename Period>
+	EQueueWaitResult WaitAndPopBulkFor(OutputIt out, size_t maxCount, size_t& outCount, const std::chrono::duration<Rep, Period>& timeout)
+	{
+		return WaitAndPopInternal(out, maxCount, outCount, TimeoutToMilliseconds(timeout));
 	}
 
 	void Cancel()
 	{
-		std::unique_lock<std::mutex> lock(_queueLock);
+		_shutdown = true;
+
+		T value;
+		while (_queue.TryPop(value))
+			DeleteQueuedObject(value);
+
+		_pushEpoch.fetch_add(1);
+		_popEpoch.fetch_add(1);
+		PlatformProcess::WakeOnAddress(&_pushEpoch, true);
+		PlatformProcess::WakeOnAddress(&_popEpoch, true);
+	}
+
+private:
+	template<typename Rep, typename Period>
+	static uint32 TimeoutToMilliseconds(const std::chrono::duration<Rep, Period>& timeout)
+	{
+		// round up, so a short timeout still sleeps instead of spinning
+		std::chrono::milliseconds milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+		if (milliseconds < timeout)
+			++milliseconds;
+		if (milliseconds.count() <= 0)
+			return 0;
+		return uint32(std::min<long long>(milliseconds.count(), PlatformProcess::InfiniteWait - 1));
+	}
 
-		while (!_queue.empty())
+	template<typename OutputIt>
+	EQueueWaitResult WaitAndPopInternal(OutputIt out, size_t maxCount, size_t& outCount, uint32 timeoutMs)
+	{
+		outCount = 0;
+		// nothing could ever be popped, so there is nothing to wait for
+		if (maxCount == 0)
+			return _shutdown ? EQueueWaitResult::Shutdown : EQueueWaitResult::Popped;
+
+		const bool timed = timeoutMs != PlatformProcess::InfiniteWait;
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timed ? timeoutMs : 0);
+		LOCK_STATS_WAIT_SCOPE(popWait, "ProducerConsumerQueue::WaitAndPop");
+		int spins = 0;
+		while (!_shutdown)
 		{
-			T& value = _queue.front();
+			outCount = _queue.PopBulk(out, maxCount);
+			if (outCount)
+			{
+				Notify(_popEpoch, _sleepingProducers, outCount > 1);
+				return EQueueWaitResult::Popped;
+			}
 
-			DeleteQueuedObject(value);
+			uint32 remainingMs = PlatformProcess::InfiniteWait;
+			if (timed)
+			{
+				const auto now = std::chrono::steady_clock::now();
+				if (now >= deadline)
+					return EQueueWaitResult::TimedOut;
+				remainingMs = TimeoutToMilliseconds(deadline - now);
+			}
 
-			_queue.pop();
+			LOCK_STATS_WAITING(popWait);
+			WaitFor(_pushEpoch, _sleepingConsumers, spins, [this]() { return !_queue.IsEmpty(); }, remainingMs);
 		}
+		return EQueueWaitResult::Shutdown;
+	}
 
-		_shutdown = true;
+	void Notify(std::atomic<uint32>& epoch, std::atomic<int32>& sleepers, bool wakeAll)
+	{
+		// pairs with the fence in WaitFor: either the sleeper sees the new state or we see the sleeper
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sleepers.load(std::memory_order_relaxed) > 0)
+		{
+			epoch.fetch_add(1, std::memory_order_release);
+			PlatformProcess::WakeOnAddress(&epoch, wakeAll);
+		}
+	}
 
-		_condition.notify_all();
+	template<typename Ready>
+	void WaitFor(std::atomic<uint32>& epoch, std::atomic<int32>& sleepers, int& spins, Ready ready, uint32 timeoutMs = PlatformProcess::InfiniteWait)
+	{
+		if (spins < SpinCount)
+		{
+			++spins;
+			CPU_PAUSE();
+			return;
+		}
+
+		const uint32 observed = epoch.load(std::memory_order_acquire);
+		sleepers.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!ready() && !_shutdown)
+			PlatformProcess::WaitOnAddress(&epoch, observed, timeoutMs);
+		sleepers.fetch_sub(1, std::memory_order_relaxed);
 	}
 
-private:
 	template<typename E = T>
 	typename std::enable_if<std::is_pointer<E>::value>::type DeleteQueuedObject(E& obj) { delete obj; }
 
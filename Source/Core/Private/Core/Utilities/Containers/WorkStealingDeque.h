@@ -0,0 +1,152 @@
+#pragma once
+
+/**
+* Chase-Lev work stealing deque (Chase & Lev 2005, with the C11 memory orders of Le et al. 2013).
+* The owning thread pushes and pops at the bottom like a stack, any other thread steals from
+* the top. Only a steal racing the owner for the very last element pays for a compare-exchange.
+* The ring grows when full; retired rings are kept until destruction because a thief may
+* still be reading from one.
+* T must be trivially copyable, it is normally a pointer.
+*/
+template<typename T>
+class WorkStealingDeque
+{
+	static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque holds trivially copyable items");
+
+	struct Ring
+	{
+		explicit Ring(int64 InCapacity)
+			: Capacity(InCapacity)
+			, Mask(InCapacity - 1)
+			, Items(new std::atomic<T>[InCapacity])
+		{
+		}
+
+		~Ring()
+		{
+			delete[] Items;
+		}
+
+		FORCEINLINE void Put(int64 Index, T Item)
+		{
+			Items[Index & Mask].store(Item, std::memory_order_relaxed);
+		}
+
+		FORCEINLINE T Get(int64 Index) const
+		{
+			return Items[Index & Mask].load(std::memory_order_relaxed);
+		}
+
+		Ring* Grow(int64 Bottom, int64 Top) const
+		{
+			Ring* Grown = new Ring(Capacity * 2);
+			for (int64 Index = Top; Index < Bottom; ++Index)
+			{
+				Grown->Put(Index, Get(Index));
+			}
+			return Grown;
+		}
+
+		const int64 Capacity;
+		const int64 Mask;
+		std::atomic<T>* Items;
+	};
+
+public:
+	/** InitialCapacity must be a power of two. */
+	explicit WorkStealingDeque(int64 InitialCapacity = 256)
+		: Top(0)
+		, Bottom(0)
+		, Array(new Ring(InitialCapacity))
+	{
+	}
+
+	~WorkStealingDeque()
+	{
+		delete Array.load(std::memory_order_relaxed);
+		for (Ring* Retired : RetiredRings)
+		{
+			delete Retired;
+		}
+	}
+
+	DISABLE_COPY_AND_ASSIGN(WorkStealingDeque);
+
+	/** Owner only. */
+	void Push(T Item)
+	{
+		const int64 B = Bottom.load(std::memory_order_relaxed);
+		const int64 T0 = Top.load(std::memory_order_acquire);
+		Ring* A = Array.load(std::memory_order_relaxed);
+		if (B - T0 > A->Capacity - 1)
+		{
+			Ring* Grown = A->Grow(B, T0);
+			RetiredRings.push_back(A);
+			Array.store(Grown, std::memory_order_release);
+			A = Grown;
+		}
+		A->Put(B, Item);
+		std::atomic_thread_fence(std::memory_order_release);
+		Bottom.store(B + 1, std::memory_order_relaxed);
+	}
+
+	/** Owner only. Takes the most recently pushed item. */
+	bool Pop(T& OutItem)
+	{
+		const int64 B = Bottom.load(std::memory_order_relaxed) - 1;
+		Ring* A = Array.load(std::memory_order_relaxed);
+		Bottom.store(B, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64 T0 = Top.load(std::memory_order_relaxed);
+
+		if (T0 > B)
+		{
+			// empty
+			Bottom.store(B + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		OutItem = A->Get(B);
+		if (T0 == B)
+		{
+			// last item, race the thieves for it
+			const bool bWon = Top.compare_exchange_strong(T0, T0 + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			Bottom.store(B + 1, std::memory_order_relaxed);
+			return bWon;
+		}
+		return true;
+	}
+
+	/** Any thread. Takes the oldest item. May fail spuriously when racing another thief. */
+	bool Steal(T& OutItem)
+	{
+		int64 T0 = Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64 B = Bottom.load(std::memory_order_acquire);
+		if (T0 >= B)
+		{
+			return false;
+		}
+
+		Ring* A = Array.load(std::memory_order_acquire);
+		const T Item = A->Get(T0);
+		if (!Top.compare_exchange_strong(T0, T0 + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return false;
+		}
+		OutItem = Item;
+		return true;
+	}
+
+	/** Approximate when called from a thief. */
+	bool IsEmpty() const
+	{
+		return Bottom.load(std::memory_order_relaxed) <= Top.load(std::memory_order_relaxed);
+	}
+
+private:
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<int64> Top;
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<int64> Bottom;
+	std::atomic<Ring*> Array;
+	std::vector<Ring*> RetiredRings;
+};
@@ -2,13 +2,24 @@
 #define LOCK__(x, y)  x ## y
 #define LOCK_(x, y) LOCK__(x, y)
 #define LOCK2 LockGuard LOCK_(lock, __LINE__) = []()
+#if CORE_LOCK_STATS
+#define SCOPED_LOCK(x) LOCK_STATS_SITE(LOCK_(lockSite, __LINE__), #x); LockGuard LOCK_(lock, __LINE__){ &LOCK_(lockSite, __LINE__) }; LOCK_(lock, __LINE__) << &x << [&]()
+#define SCOPED_LOCK_GUARD(x) LOCK_STATS_SITE(LOCK_(lockSite, __LINE__), #x); \
+	InstrumentedLock<typename std::remove_reference<decltype(x)>::type> LOCK_(lockTimer, __LINE__)(x, LOCK_(lockSite, __LINE__)); \
+	std::lock_guard<decltype(LOCK_(lockTimer, __LINE__))> LOCK_(lockGuard, __LINE__)(LOCK_(lockTimer, __LINE__))
+#else
 #define SCOPED_LOCK(x) LockGuard LOCK_(lock, __LINE__); LOCK_(lock, __LINE__) << &x << [&]()
+// Holds x, any Lockable (std::mutex, SpinMutex, AdaptiveMutex...), until the end of the enclosing scope.
+#define SCOPED_LOCK_GUARD(x) std::lock_guard<typename std::remove_reference<decltype(x)>::type> LOCK_(lockGuard, __LINE__)(x)
+#endif
 
+#ifndef FORCEINLINE
 #if PLATFORM_WINDOWS
 #define FORCEINLINE __forceinline
 #else
 #define FORCEINLINE inline
 #endif
+#endif
 
 #define STR_CONCAT(a, b) STR_CONCAT_I(a, b)
 #define STR_CONCAT_I(a, b) STR_CONCAT_II(~, a ## b)
@@ -50,19 +61,37 @@ struct LockGuard
 	}
 	*/
 
-	FORCEINLINE LockGuard& operator<< (std::mutex* Mutex)
+	// Runs the lambda with the mutex held. The mutex is released by a destructor, so it is
+	// unlocked even if the lambda throws.
+	template<class MutexType>
+	struct Binding
 	{
-		this->Mutex = Mutex;
-		return *this;
-	}
+		template<class Callable>
+		FORCEINLINE void operator<< (Callable&& Lambda)
+		{
+#if CORE_LOCK_STATS
+			InstrumentedLock<MutexType> Timed(*Mutex, *Site);
+			std::lock_guard<InstrumentedLock<MutexType>> Lock(Timed);
+#else
+			std::lock_guard<MutexType> Lock(*Mutex);
+#endif
+			Lambda();
+		}
 
-	template<class Callable>
-	FORCEINLINE void operator<< (Callable Lambda)
+		MutexType* Mutex;
+#if CORE_LOCK_STATS
+		const LockSite* Site;
+#endif
+	};
+
+	template<class MutexType>
+	FORCEINLINE Binding<MutexType> operator<< (MutexType* Mutex)
 	{
-		Mutex->lock();
-		Lambda();
-		Mutex->unlock();
-		//return *this;
+#if CORE_LOCK_STATS
+		return Binding<MutexType>{ Mutex, Site };
+#else
+		return Binding<MutexType>{ Mutex };
+#endif
 	}
 
 /*
@@ -80,7 +109,9 @@ struct LockGuard
 	//LockGuard(const LockGuard&) = delete;
 	//void operator = (const LockGuard&) = delete;
 
-	std::mutex* Mutex;
 	//std::function<void()> Lambda;
 
+#if CORE_LOCK_STATS
+	const LockSite* Site;
+#endif
 };
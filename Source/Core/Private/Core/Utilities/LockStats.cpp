@@ -0,0 +1,245 @@
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+#if PLATFORM_LINUX
+#include <signal.h>
+#endif
+
+namespace
+{
+	const uint32 SitesPerChunk = 256;
+	const uint32 MaxChunks = 64;
+
+	struct SiteCounters
+	{
+		std::atomic<uint64> Acquires{ 0 };
+		std::atomic<uint64> Contended{ 0 };
+		std::atomic<uint64> WaitCycles{ 0 };
+		std::atomic<uint64> MaxWaitCycles{ 0 };
+	};
+
+	/** Counters of one thread. Only the owning thread writes, chunks are allocated on first use. */
+	struct ThreadTable
+	{
+		std::atomic<SiteCounters*> Chunks[MaxChunks] = {};
+	};
+
+	struct Registry
+	{
+		std::mutex Mutex;
+		std::vector<const LockSite*> Sites;
+		std::vector<ThreadTable*> Tables;	// kept after their thread exits
+		std::string DumpPath;
+		std::atomic<uint32> DumpRequests{ 0 };
+	};
+
+	/** Never destroyed, locks are still taken while static objects are torn down. */
+	Registry& GetRegistry()
+	{
+		static Registry* Instance = new Registry();
+		return *Instance;
+	}
+
+	thread_local ThreadTable* LocalTable = nullptr;
+
+	ThreadTable& GetLocalTable()
+	{
+		if (UNLIKELY(!LocalTable))
+		{
+			LocalTable = new ThreadTable();
+			Registry& Reg = GetRegistry();
+			std::lock_guard<std::mutex> Lock(Reg.Mutex);
+			Reg.Tables.push_back(LocalTable);
+		}
+		return *LocalTable;
+	}
+
+	/** Single writer, so a relaxed load and store is enough and avoids a locked instruction. */
+	FORCEINLINE void Add(std::atomic<uint64>& Counter, uint64 Value)
+	{
+		Counter.store(Counter.load(std::memory_order_relaxed) + Value, std::memory_order_relaxed);
+	}
+
+#if CORE_LOCK_STATS
+	void DumpAtExit()
+	{
+		LockStats::DumpJson(GetRegistry().DumpPath.c_str());
+	}
+
+#if PLATFORM_LINUX
+	/** Only touches a lock-free atomic and makes a futex call, both are async signal safe. */
+	void RequestDump(int)
+	{
+		Registry& Reg = GetRegistry();
+		Reg.DumpRequests.fetch_add(1);
+		PlatformProcess::WakeOnAddress(&Reg.DumpRequests);
+	}
+
+	void DumpOnRequest()
+	{
+		Registry& Reg = GetRegistry();
+		uint32 Seen = Reg.DumpRequests.load();
+		while (true)
+		{
+			PlatformProcess::WaitOnAddress(&Reg.DumpRequests, Seen);
+			const uint32 Requested = Reg.DumpRequests.load();
+			if (Requested != Seen)
+			{
+				Seen = Requested;
+				LockStats::DumpJson(Reg.DumpPath.c_str());
+			}
+		}
+	}
+#endif
+#endif // CORE_LOCK_STATS
+}
+
+LockSite::LockSite(const char* InFile, int32 InLine, const char* InName)
+	: File(InFile)
+	, Line(InLine)
+	, Name(InName)
+{
+	Registry& Reg = GetRegistry();
+	std::lock_guard<std::mutex> Lock(Reg.Mutex);
+	Id = static_cast<uint32>(Reg.Sites.size());
+	Reg.Sites.push_back(this);
+}
+
+void LockStats::Record(const LockSite& Site, uint64 WaitCycles)
+{
+	if (UNLIKELY(Site.Id >= SitesPerChunk * MaxChunks))
+	{
+		return;
+	}
+
+	std::atomic<SiteCounters*>& Slot = GetLocalTable().Chunks[Site.Id / SitesPerChunk];
+	SiteCounters* Chunk = Slot.load(std::memory_order_relaxed);
+	if (UNLIKELY(!Chunk))
+	{
+		Chunk = new SiteCounters[SitesPerChunk];
+		Slot.store(Chunk, std::memory_order_release);
+	}
+
+	SiteCounters& Counters = Chunk[Site.Id % SitesPerChunk];
+	Add(Counters.Acquires, 1);
+	if (WaitCycles)
+	{
+		Add(Counters.Contended, 1);
+		Add(Counters.WaitCycles, WaitCycles);
+		if (WaitCycles > Counters.MaxWaitCycles.load(std::memory_order_relaxed))
+		{
+			Counters.MaxWaitCycles.store(WaitCycles, std::memory_order_relaxed);
+		}
+	}
+}
+
+void LockStats::Collect(std::vector<LockSiteStats>& OutStats)
+{
+	OutStats.clear();
+	const double SecondsPerCycle = PlatformTime::GetSecondsPerCycle64();
+
+	Registry& Reg = GetRegistry();
+	std::lock_guard<std::mutex> Lock(Reg.Mutex);
+	for (const LockSite* Site : Reg.Sites)
+	{
+		if (Site->Id >= SitesPerChunk * MaxChunks)
+		{
+			continue;
+		}
+
+		LockSiteStats Totals = { Site, 0, 0, 0.0, 0.0 };
+		uint64 WaitCycles = 0;
+		uint64 MaxWaitCycles = 0;
+		for (ThreadTable* Table : Reg.Tables)
+		{
+			const SiteCounters* Chunk = Table->Chunks[Site->Id / SitesPerChunk].load(std::memory_order_acquire);
+			if (!Chunk)
+			{
+				continue;
+			}
+			const SiteCounters& Counters = Chunk[Site->Id % SitesPerChunk];
+			Totals.Acquires += Counters.Acquires.load(std::memory_order_relaxed);
+			Totals.Contended += Counters.Contended.load(std::memory_order_relaxed);
+			WaitCycles += Counters.WaitCycles.load(std::memory_order_relaxed);
+			MaxWaitCycles = std::max(MaxWaitCycles, Counters.MaxWaitCycles.load(std::memory_order_relaxed));
+		}
+
+		if (Totals.Acquires)
+		{
+			Totals.TotalWaitSeconds = WaitCycles * SecondsPerCycle;
+			Totals.MaxWaitSeconds = MaxWaitCycles * SecondsPerCycle;
+			OutStats.push_back(Totals);
+		}
+	}
+}
+
+void LockStats::WriteJson(std::string& OutJson)
+{
+	std::vector<LockSiteStats> Stats;
+	Collect(Stats);
+	std::sort(Stats.begin(), Stats.end(), [](const LockSiteStats& A, const LockSiteStats& B) { return A.TotalWaitSeconds > B.TotalWaitSeconds; });
+
+	rapidjson::StringBuffer Buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> Writer(Buffer);
+	Writer.StartObject();
+	Writer.Key("lockSites");
+	Writer.StartArray();
+	for (const LockSiteStats& Each : Stats)
+	{
+		Writer.StartObject();
+		Writer.Key("file");
+		Writer.String(Each.Site->File);
+		Writer.Key("line");
+		Writer.Int(Each.Site->Line);
+		Writer.Key("name");
+		Writer.String(Each.Site->Name);
+		Writer.Key("acquires");
+		Writer.Uint64(Each.Acquires);
+		Writer.Key("contended");
+		Writer.Uint64(Each.Contended);
+		Writer.Key("totalWaitMs");
+		Writer.Double(Each.TotalWaitSeconds * 1000.0);
+		Writer.Key("maxWaitMs");
+		Writer.Double(Each.MaxWaitSeconds * 1000.0);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+	OutJson.assign(Buffer.GetString(), Buffer.GetSize());
+}
+
+bool LockStats::DumpJson(const char* Path)
+{
+	std::string Json;
+	WriteJson(Json);
+
+	FILE* File = fopen(Path, "wb");
+	if (!File)
+	{
+		return false;
+	}
+	const bool bWritten = fwrite(Json.data(), 1, Json.size(), File) == Json.size();
+	return fclose(File) == 0 && bWritten;
+}
+
+#if CORE_LOCK_STATS
+void LockStats::DumpOnExit(const char* Path)
+{
+	Registry& Reg = GetRegistry();
+	const bool bFirstCall = Reg.DumpPath.empty();
+	Reg.DumpPath = Path;
+	if (!bFirstCall)
+	{
+		return;
+	}
+
+	atexit(&DumpAtExit);
+#if PLATFORM_LINUX
+	std::thread(&DumpOnRequest).detach();
+	signal(SIGUSR1, &RequestDump);
+#endif
+}
+#else
+void LockStats::DumpOnExit(const char* /*Path*/)
+{
+}
+#endif // CORE_LOCK_STATS
@@ -0,0 +1,151 @@
+#pragma once
+
+/**
+* Lock contention statistics, compiled in with CORE_LOCK_STATS=1 (off by default).
+* Every SCOPED_LOCK / SCOPED_LOCK_GUARD and the blocking calls of ProducerConsumerQueue become a
+* LockSite, a static object per call site. Each thread counts into its own table indexed by
+* site id, so recording is a few relaxed stores on memory no other thread writes. The tables
+* are only summed up when the statistics are dumped.
+*/
+#ifndef CORE_LOCK_STATS
+#define CORE_LOCK_STATS 0
+#endif
+
+/**
+* One place in the code that takes a lock or waits on a queue
+**/
+struct Core_API LockSite
+{
+	LockSite(const char* InFile, int32 InLine, const char* InName);
+
+	const char* File;
+	int32 Line;
+	const char* Name;	// the locked expression or the waiting function
+	uint32 Id;			// index into the per thread tables
+};
+
+/**
+* Totals for one LockSite, see LockStats::Collect
+**/
+struct LockSiteStats
+{
+	const LockSite* Site;
+	uint64 Acquires;		// locks taken, or items waited for
+	uint64 Contended;		// of those, how many had to wait
+	double TotalWaitSeconds;
+	double MaxWaitSeconds;
+};
+
+class Core_API LockStats
+{
+public:
+	/** Counts one acquire at Site, WaitCycles in PlatformTime::Cycles64 units, 0 when uncontended. */
+	static void Record(const LockSite& Site, uint64 WaitCycles);
+
+	/** Sums the tables of all threads, including threads that have exited. */
+	static void Collect(std::vector<LockSiteStats>& OutStats);
+
+	/** Writes the collected statistics as a JSON array, sites sorted by total wait time. */
+	static void WriteJson(std::string& OutJson);
+
+	/** Writes the JSON to Path. Returns false if the file cannot be written. */
+	static bool DumpJson(const char* Path);
+
+	/**
+	* Dumps the statistics to Path when the process exits and, on Linux, whenever it receives
+	* SIGUSR1. Does nothing unless CORE_LOCK_STATS is enabled.
+	*/
+	static void DumpOnExit(const char* Path);
+};
+
+#if CORE_LOCK_STATS
+
+/**
+* Lockable wrapper that times how long acquiring the wrapped lock takes
+**/
+template<class MutexType>
+class InstrumentedLock
+{
+public:
+	InstrumentedLock(MutexType& InMutex, const LockSite& InSite)
+		: Mutex(InMutex)
+		, Site(InSite)
+	{
+	}
+
+	void lock()
+	{
+		if (Mutex.try_lock())
+		{
+			LockStats::Record(Site, 0);
+			return;
+		}
+
+		const uint64 Start = PlatformTime::Cycles64();
+		Mutex.lock();
+		// a wait too short to measure still counts as contended
+		LockStats::Record(Site, std::max<uint64>(PlatformTime::Cycles64() - Start, 1));
+	}
+
+	bool try_lock()
+	{
+		const bool bLocked = Mutex.try_lock();
+		if (bLocked)
+		{
+			LockStats::Record(Site, 0);
+		}
+		return bLocked;
+	}
+
+	void unlock()
+	{
+		Mutex.unlock();
+	}
+
+private:
+	MutexType& Mutex;
+	const LockSite& Site;
+};
+
+/**
+* Records one acquire at a site when it goes out of scope, contended if Waiting was called
+**/
+class LockWaitTimer
+{
+public:
+	explicit LockWaitTimer(const LockSite& InSite)
+		: Site(InSite)
+		, Start(0)
+	{
+	}
+
+	~LockWaitTimer()
+	{
+		LockStats::Record(Site, Start ? std::max<uint64>(PlatformTime::Cycles64() - Start, 1) : 0);
+	}
+
+	/** Marks the start of the wait, later calls are ignored. */
+	FORCEINLINE void Waiting()
+	{
+		if (!Start)
+		{
+			Start = PlatformTime::Cycles64();
+		}
+	}
+
+private:
+	const LockSite& Site;
+	uint64 Start;
+};
+
+#define LOCK_STATS_SITE(Var, Name) static const LockSite Var(__FILE__, __LINE__, Name)
+#define LOCK_STATS_WAIT_SCOPE(Var, Name) LOCK_STATS_SITE(Var##Site, Name); LockWaitTimer Var(Var##Site)
+#define LOCK_STATS_WAITING(Var) Var.Waiting()
+
+#else
+
+#define LOCK_STATS_SITE(Var, Name)
+#define LOCK_STATS_WAIT_SCOPE(Var, Name)
+#define LOCK_STATS_WAITING(Var)
+
+#endif // CORE_LOCK_STATS
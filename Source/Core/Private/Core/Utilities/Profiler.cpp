@@ -0,0 +1,202 @@
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+std::atomic<bool> Profiler::bEnabled{ false };
+
+namespace
+{
+	const uint32 EventsPerThread = 1 << 16;
+
+	/** Events of one thread. Only the owning thread writes, Written counts every event ever recorded. */
+	struct ThreadEvents
+	{
+		std::unique_ptr<ProfileEvent[]> Ring{ new ProfileEvent[EventsPerThread] };
+		std::atomic<uint64> Written{ 0 };
+		uint32 ThreadId = 0;
+		std::string Name;
+	};
+
+	struct Registry
+	{
+		std::mutex Mutex;
+		std::vector<ThreadEvents*> Threads;	// kept after their thread exits
+		std::unordered_set<std::string> Details;
+		std::string DumpPath;
+		uint64 BaseCycles = 0;
+	};
+
+	/** Never destroyed, the trace is written from an atexit handler. */
+	Registry& GetRegistry()
+	{
+		static Registry* Instance = new Registry();
+		return *Instance;
+	}
+
+	thread_local ThreadEvents* LocalEvents = nullptr;
+
+	ThreadEvents& GetLocalEvents()
+	{
+		if (UNLIKELY(!LocalEvents))
+		{
+			LocalEvents = new ThreadEvents();
+			Registry& Reg = GetRegistry();
+			std::lock_guard<std::mutex> Lock(Reg.Mutex);
+			LocalEvents->ThreadId = static_cast<uint32>(Reg.Threads.size()) + 1;
+			Reg.Threads.push_back(LocalEvents);
+		}
+		return *LocalEvents;
+	}
+
+	void DumpAtExit()
+	{
+		Profiler::DumpChromeTrace(GetRegistry().DumpPath.c_str());
+	}
+}
+
+void Profiler::Start()
+{
+	Registry& Reg = GetRegistry();
+	{
+		std::lock_guard<std::mutex> Lock(Reg.Mutex);
+		if (!Reg.BaseCycles)
+		{
+			Reg.BaseCycles = PlatformTime::Cycles64();
+		}
+	}
+	bEnabled.store(true);
+}
+
+void Profiler::Stop()
+{
+	bEnabled.store(false);
+}
+
+void Profiler::Record(const char* Name, const char* Detail, uint64 StartCycles, uint64 EndCycles)
+{
+	ThreadEvents& Events = GetLocalEvents();
+	const uint64 Written = Events.Written.load(std::memory_order_relaxed);
+	ProfileEvent& Event = Events.Ring[Written % EventsPerThread];
+	Event.Name = Name;
+	Event.Detail = Detail;
+	Event.StartCycles = StartCycles;
+	Event.EndCycles = EndCycles;
+	Events.Written.store(Written + 1, std::memory_order_release);
+}
+
+const char* Profiler::InternDetail(const std::string& Text)
+{
+	Registry& Reg = GetRegistry();
+	std::lock_guard<std::mutex> Lock(Reg.Mutex);
+	return Reg.Details.insert(Text).first->c_str();
+}
+
+void Profiler::SetThreadName(const std::string& Name)
+{
+	ThreadEvents& Events = GetLocalEvents();
+	std::lock_guard<std::mutex> Lock(GetRegistry().Mutex);
+	Events.Name = Name;
+}
+
+void Profiler::WriteChromeTrace(std::string& OutJson)
+{
+	Registry& Reg = GetRegistry();
+	std::lock_guard<std::mutex> Lock(Reg.Mutex);
+	const double MicrosecondsPerCycle = PlatformTime::GetSecondsPerCycle64() * 1e6;
+
+	rapidjson::StringBuffer Buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> Writer(Buffer);
+	Writer.StartObject();
+	Writer.Key("displayTimeUnit");
+	Writer.String("ms");
+	Writer.Key("traceEvents");
+	Writer.StartArray();
+	for (const ThreadEvents* Events : Reg.Threads)
+	{
+		if (!Events->Name.empty())
+		{
+			Writer.StartObject();
+			Writer.Key("name");
+			Writer.String("thread_name");
+			Writer.Key("ph");
+			Writer.String("M");
+			Writer.Key("pid");
+			Writer.Uint(1);
+			Writer.Key("tid");
+			Writer.Uint(Events->ThreadId);
+			Writer.Key("args");
+			Writer.StartObject();
+			Writer.Key("name");
+			Writer.String(Events->Name.c_str(), static_cast<rapidjson::SizeType>(Events->Name.size()));
+			Writer.EndObject();
+			Writer.EndObject();
+		}
+
+		const uint64 Written = Events->Written.load(std::memory_order_acquire);
+		const uint64 First = Written > EventsPerThread ? Written - EventsPerThread : 0;
+		for (uint64 Index = First; Index < Written; ++Index)
+		{
+			const ProfileEvent& Event = Events->Ring[Index % EventsPerThread];
+			// events from before Start, or from an earlier run, have no place on the time line
+			if (Event.StartCycles < Reg.BaseCycles)
+			{
+				continue;
+			}
+
+			Writer.StartObject();
+			Writer.Key("name");
+			Writer.String(Event.Name);
+			Writer.Key("ph");
+			Writer.String("X");
+			Writer.Key("pid");
+			Writer.Uint(1);
+			Writer.Key("tid");
+			Writer.Uint(Events->ThreadId);
+			Writer.Key("ts");
+			Writer.Double((Event.StartCycles - Reg.BaseCycles) * MicrosecondsPerCycle);
+			Writer.Key("dur");
+			Writer.Double((Event.EndCycles - Event.StartCycles) * MicrosecondsPerCycle);
+			if (Event.Detail)
+			{
+				Writer.Key("args");
+				Writer.StartObject();
+				Writer.Key("detail");
+				Writer.String(Event.Detail);
+				Writer.EndObject();
+			}
+			Writer.EndObject();
+		}
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+	OutJson.assign(Buffer.GetString(), Buffer.GetSize());
+}
+
+bool Profiler::DumpChromeTrace(const char* Path)
+{
+	std::string Json;
+	WriteChromeTrace(Json);
+
+	FILE* File = fopen(Path, "wb");
+	if (!File)
+	{
+		return false;
+	}
+	const bool bWritten = fwrite(Json.data(), 1, Json.size(), File) == Json.size();
+	return fclose(File) == 0 && bWritten;
+}
+
+void Profiler::DumpOnExit(const char* Path)
+{
+	Registry& Reg = GetRegistry();
+	bool bFirstCall;
+	{
+		std::lock_guard<std::mutex> Lock(Reg.Mutex);
+		bFirstCall = Reg.DumpPath.empty();
+		Reg.DumpPath = Path;
+	}
+	if (bFirstCall)
+	{
+		atexit(&DumpAtExit);
+	}
+	Start();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+* Scoped timer profiling, exported in the Chrome Trace Event format (chrome://tracing, Perfetto).
+* PROFILE_SCOPE("name") times the rest of the enclosing scope. Nested scopes show up as a call
+* hierarchy, because the viewer nests events by their time ranges. While the profiler is stopped a
+* scope costs one relaxed load. While it runs, a scope reads the cycle counter twice and
+* appends one event to a ring buffer owned by the calling thread; when the ring is full the
+* oldest events are overwritten.
+* Names must outlive the profiler, normally they are string literals. Run time strings go in
+* as the detail of PROFILE_SCOPE_DETAIL, which copies them once per distinct value.
+*/
+
+struct ProfileEvent
+{
+	const char* Name;
+	const char* Detail;		// null, or an interned string shown in the event's args
+	uint64 StartCycles;
+	uint64 EndCycles;
+};
+
+class Core_API Profiler
+{
+public:
+	static void Start();
+	static void Stop();
+
+	static FORCEINLINE bool IsEnabled()
+	{
+		return bEnabled.load(std::memory_order_relaxed);
+	}
+
+	/** Appends an event to the calling thread's ring buffer. */
+	static void Record(const char* Name, const char* Detail, uint64 StartCycles, uint64 EndCycles);
+
+	/** Returns a copy of Text that lives until the process exits, the same pointer for equal strings. */
+	static const char* InternDetail(const std::string& Text);
+
+	/** Names the calling thread in the trace. */
+	static void SetThreadName(const std::string& Name);
+
+	/**
+	* Writes the recorded events of all threads as a Chrome trace.
+	* Threads still recording while this runs may lose their latest events.
+	*/
+	static void WriteChromeTrace(std::string& OutJson);
+
+	/** Writes the trace to Path. Returns false if the file cannot be written. */
+	static bool DumpChromeTrace(const char* Path);
+
+	/** Starts the profiler and writes the trace to Path when the process exits. */
+	static void DumpOnExit(const char* Path);
+
+private:
+	static std::atomic<bool> bEnabled;
+};
+
+class ScopedProfileEvent
+{
+public:
+	FORCEINLINE explicit ScopedProfileEvent(const char* InName)
+		: Name(Profiler::IsEnabled() ? InName : nullptr)
+		, Detail(nullptr)
+		, StartCycles(Name ? PlatformTime::Cycles64() : 0)
+	{
+	}
+
+	FORCEINLINE ScopedProfileEvent(const char* InName, const std::string& InDetail)
+		: Name(Profiler::IsEnabled() ? InName : nullptr)
+		, Detail(Name ? Profiler::InternDetail(InDetail) : nullptr)
+		, StartCycles(Name ? PlatformTime::Cycles64() : 0)
+	{
+	}
+
+	FORCEINLINE ~ScopedProfileEvent()
+	{
+		if (Name)
+		{
+			Profiler::Record(Name, Detail, StartCycles, PlatformTime::Cycles64());
+		}
+	}
+
+	DISABLE_COPY_AND_ASSIGN(ScopedProfileEvent);
+
+private:
+	const char* Name;
+	const char* Detail;
+	uint64 StartCycles;
+};
+
+#define PROFILE_SCOPE(Name) ScopedProfileEvent STR_CONCAT(profileScope, __LINE__)(Name)
+#define PROFILE_SCOPE_DETAIL(Name, Detail) ScopedProfileEvent STR_CONCAT(profileScope, __LINE__)(Name, Detail)
@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+* Test and test-and-set spin lock with exponential backoff. Never sleeps in the kernel, so it
+* only suits critical sections of a few dozen instructions that are rarely contended; waiters
+* yield their time slice once the backoff is exhausted.
+* Meets the Lockable requirements, use it with SCOPED_LOCK_GUARD or std::lock_guard.
+*/
+class SpinMutex
+{
+public:
+	SpinMutex() = default;
+	DISABLE_COPY_AND_ASSIGN(SpinMutex);
+
+	FORCEINLINE bool try_lock()
+	{
+		return !Locked.load(std::memory_order_relaxed) && !Locked.exchange(true, std::memory_order_acquire);
+	}
+
+	void lock()
+	{
+		while (!try_lock())
+		{
+			// spin on a plain load, the cache line stays shared until the owner releases it
+			uint32 Backoff = 1;
+			while (Locked.load(std::memory_order_relaxed))
+			{
+				for (uint32 Pause = 0; Pause < Backoff; ++Pause)
+				{
+					CPU_PAUSE();
+				}
+				if (Backoff < MaxBackoff)
+				{
+					Backoff *= 2;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+
+	FORCEINLINE void unlock()
+	{
+		Locked.store(false, std::memory_order_release);
+	}
+
+private:
+	static const uint32 MaxBackoff = 64;
+
+	std::atomic<bool> Locked{ false };
+};
+
+/**
+* Mutex that spins briefly before it parks the thread on PlatformProcess::WaitOnAddress
+* (a futex on Linux). An uncontended lock and unlock is one atomic operation each and never
+* enters the kernel; unlock only makes a wake up call when some thread is actually parked.
+* The state machine is the one from Drepper's "Futexes Are Tricky".
+* Meets the Lockable requirements, use it with SCOPED_LOCK_GUARD or std::lock_guard.
+*/
+class AdaptiveMutex
+{
+public:
+	AdaptiveMutex() = default;
+	DISABLE_COPY_AND_ASSIGN(AdaptiveMutex);
+
+	FORCEINLINE bool try_lock()
+	{
+		uint32 Expected = Unlocked;
+		return State.compare_exchange_strong(Expected, Locked, std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	void lock()
+	{
+		if (LIKELY(try_lock()))
+		{
+			return;
+		}
+
+		for (uint32 Spin = 0; Spin < SpinCount; ++Spin)
+		{
+			CPU_PAUSE();
+			if (State.load(std::memory_order_relaxed) == Unlocked && try_lock())
+			{
+				return;
+			}
+		}
+
+		// mark the lock contended, so the owner wakes us when it lets go
+		while (State.exchange(Contended, std::memory_order_acquire) != Unlocked)
+		{
+			PlatformProcess::WaitOnAddress(&State, Contended);
+		}
+	}
+
+	FORCEINLINE void unlock()
+	{
+		if (UNLIKELY(State.exchange(Unlocked, std::memory_order_release) == Contended))
+		{
+			PlatformProcess::WakeOnAddress(&State);
+		}
+	}
+
+private:
+	static const uint32 Unlocked = 0;
+	static const uint32 Locked = 1;
+	static const uint32 Contended = 2;	// locked, and threads may be parked on State
+	static const uint32 SpinCount = 100;
+
+	std::atomic<uint32> State{ Unlocked };
+};
@@ -0,0 +1,294 @@
+struct TaskScheduler::Worker
+{
+	uint32 Index = 0;
+	uint32 RandomState = 0;
+	WorkStealingDeque<Task*> Deque;
+	std::thread Thread;
+};
+
+namespace
+{
+	/** Scheduler and worker index of the worker running on this thread, null on other threads. */
+	thread_local TaskScheduler* CurrentScheduler = nullptr;
+	thread_local uint32 CurrentWorkerIndex = 0;
+}
+
+TaskScheduler::TaskScheduler(uint32 NumWorkers)
+{
+	if (NumWorkers == 0)
+	{
+		const uint32 NumHardwareThreads = PlatformProcess::NumberOfCoresIncludingHyperthreads();
+		NumWorkers = NumHardwareThreads > 1 ? NumHardwareThreads - 1 : 1;
+	}
+
+	Workers.reserve(NumWorkers);
+	for (uint32 Index = 0; Index < NumWorkers; ++Index)
+	{
+		std::unique_ptr<Worker> NewWorker(new Worker());
+		NewWorker->Index = Index;
+		NewWorker->RandomState = 0x9E3779B9u * (Index + 1);
+		Workers.push_back(std::move(NewWorker));
+	}
+
+	// start only once the worker array is complete, thieves walk it
+	for (std::unique_ptr<Worker>& Each : Workers)
+	{
+		Worker* Self = Each.get();
+		Self->Thread = std::thread([this, Self]() { WorkerMain(Self); });
+	}
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> Lock(SleepLock);
+		bShutdown.store(true);
+	}
+	SleepCondition.notify_all();
+
+	for (std::unique_ptr<Worker>& Each : Workers)
+	{
+		// exit() called from inside a task destroys the scheduler on a worker thread
+		if (Each->Thread.get_id() == std::this_thread::get_id())
+		{
+			Each->Thread.detach();
+		}
+		else if (Each->Thread.joinable())
+		{
+			Each->Thread.join();
+		}
+	}
+
+	// tasks injected after the workers stopped looking
+	Task* Leftover = nullptr;
+	while (InjectionQueue.try_dequeue(Leftover))
+	{
+		Execute(Leftover);
+	}
+}
+
+TaskScheduler& TaskScheduler::Get()
+{
+	static TaskScheduler Instance;
+	return Instance;
+}
+
+TaskHandle TaskScheduler::Spawn(std::function<void()> Work)
+{
+	return SpawnInternal(std::move(Work), nullptr, 0);
+}
+
+TaskHandle TaskScheduler::Spawn(std::function<void()> Work, std::initializer_list<TaskHandle> Dependencies)
+{
+	return SpawnInternal(std::move(Work), Dependencies.begin(), Dependencies.size());
+}
+
+TaskHandle TaskScheduler::Spawn(std::function<void()> Work, const std::vector<TaskHandle>& Dependencies)
+{
+	return SpawnInternal(std::move(Work), Dependencies.data(), Dependencies.size());
+}
+
+TaskHandle TaskScheduler::SpawnInternal(std::function<void()>&& Work, const TaskHandle* Dependencies, size_t NumDependencies)
+{
+	TaskHandle NewTask = std::make_shared<Task>();
+	NewTask->Work = std::move(Work);
+	NewTask->Self = NewTask;
+	NewTask->PendingDependencies.store(static_cast<int32>(NumDependencies) + 1, std::memory_order_relaxed);
+
+	int32 Satisfied = 1;
+	for (size_t Index = 0; Index < NumDependencies; ++Index)
+	{
+		Task* Dependency = Dependencies[Index].get();
+		if (!Dependency)
+		{
+			++Satisfied;
+			continue;
+		}
+
+		SCOPED_LOCK_GUARD(Dependency->ContinuationLock);
+		if (Dependency->bFinished.load(std::memory_order_acquire))
+		{
+			++Satisfied;
+		}
+		else
+		{
+			Dependency->Continuations.push_back(NewTask);
+		}
+	}
+
+	if (NewTask->PendingDependencies.fetch_sub(Satisfied, std::memory_order_acq_rel) == Satisfied)
+	{
+		Enqueue(NewTask.get());
+	}
+	return NewTask;
+}
+
+void TaskScheduler::Enqueue(Task* Ready)
+{
+	if (CurrentScheduler == this)
+	{
+		Workers[CurrentWorkerIndex]->Deque.Push(Ready);
+	}
+	else
+	{
+		InjectionQueue.enqueue(Ready);
+	}
+
+	NumQueued.fetch_add(1, std::memory_order_seq_cst);
+	if (NumSleeping.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> Lock(SleepLock);
+		SleepCondition.notify_one();
+	}
+}
+
+bool TaskScheduler::TryRunOne()
+{
+	Worker* Self = CurrentScheduler == this ? Workers[CurrentWorkerIndex].get() : nullptr;
+	Task* Next = nullptr;
+
+	bool bFound = Self && Self->Deque.Pop(Next);
+	if (!bFound)
+	{
+		bFound = InjectionQueue.try_dequeue(Next);
+	}
+	if (!bFound && !Workers.empty())
+	{
+		// start at a random victim so thieves spread out
+		uint32 Start = 0;
+		if (Self)
+		{
+			Self->RandomState ^= Self->RandomState << 13;
+			Self->RandomState ^= Self->RandomState >> 17;
+			Self->RandomState ^= Self->RandomState << 5;
+			Start = Self->RandomState;
+		}
+
+		const uint32 NumWorkers = static_cast<uint32>(Workers.size());
+		for (uint32 Offset = 0; Offset < NumWorkers && !bFound; ++Offset)
+		{
+			Worker* Victim = Workers[(Start + Offset) % NumWorkers].get();
+			if (Victim != Self)
+			{
+				bFound = Victim->Deque.Steal(Next);
+			}
+		}
+	}
+
+	if (!bFound)
+	{
+		return false;
+	}
+
+	NumQueued.fetch_sub(1, std::memory_order_relaxed);
+	Execute(Next);
+	return true;
+}
+
+void TaskScheduler::Execute(Task* Ready)
+{
+	if (Ready->Work)
+	{
+		Ready->Work();
+		Ready->Work = nullptr;
+	}
+
+	std::vector<TaskHandle> Released;
+	{
+		SCOPED_LOCK_GUARD(Ready->ContinuationLock);
+		Ready->bFinished.store(true, std::memory_order_release);
+		Released.swap(Ready->Continuations);
+	}
+
+	for (TaskHandle& Continuation : Released)
+	{
+		if (Continuation->PendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Enqueue(Continuation.get());
+		}
+	}
+
+	if (NumHelping.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> Lock(CompletionLock);
+		CompletionCondition.notify_all();
+	}
+
+	// may destroy the task
+	TaskHandle Finished = std::move(Ready->Self);
+}
+
+void TaskScheduler::WorkerMain(Worker* Self)
+{
+	CurrentScheduler = this;
+	CurrentWorkerIndex = Self->Index;
+	if (Profiler::IsEnabled())
+	{
+		Profiler::SetThreadName("TaskScheduler worker " + std::to_string(Self->Index));
+	}
+
+	while (true)
+	{
+		if (TryRunOne())
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> Lock(SleepLock);
+		NumSleeping.fetch_add(1, std::memory_order_seq_cst);
+		while (NumQueued.load(std::memory_order_seq_cst) == 0 && !bShutdown.load())
+		{
+			SleepCondition.wait(Lock);
+		}
+		NumSleeping.fetch_sub(1, std::memory_order_relaxed);
+
+		if (bShutdown.load() && NumQueued.load() == 0)
+		{
+			break;
+		}
+	}
+
+	CurrentScheduler = nullptr;
+}
+
+void TaskScheduler::HelpUntil(const std::function<bool()>& IsDone)
+{
+	while (!IsDone())
+	{
+		if (TryRunOne())
+		{
+			continue;
+		}
+
+		// nothing to run here, the task being waited on is running elsewhere
+		NumHelping.fetch_add(1, std::memory_order_seq_cst);
+		{
+			std::unique_lock<std::mutex> Lock(CompletionLock);
+			if (!IsDone())
+			{
+				// the timeout picks up tasks queued while this thread was asleep
+				CompletionCondition.wait_for(Lock, std::chrono::milliseconds(1));
+			}
+		}
+		NumHelping.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void TaskScheduler::Wait(const TaskHandle& Handle)
+{
+	if (!Handle)
+	{
+		return;
+	}
+
+	Task* Awaited = Handle.get();
+	HelpUntil([Awaited]() { return Awaited->IsFinished(); });
+}
+
+void TaskScheduler::Wait(WaitGroup& Group)
+{
+	HelpUntil([&Group]() { return Group.IsDone(); });
+
+	// let the last Done leave the group before the caller can destroy it
+	Group.Wait();
+}
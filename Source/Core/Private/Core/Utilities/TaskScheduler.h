@@ -0,0 +1,198 @@
+#pragma once
+
+class TaskScheduler;
+
+/**
+* A unit of work for the TaskScheduler.
+* A task becomes runnable once every task it depends on has finished. Continuations are the
+* reverse edges: tasks waiting on this one, released when it finishes.
+*/
+class Task
+{
+public:
+	bool IsFinished() const
+	{
+		return bFinished.load(std::memory_order_acquire);
+	}
+
+private:
+	friend class TaskScheduler;
+
+	std::function<void()> Work;
+
+	/** Unfinished dependencies, plus one held by Spawn until the task is fully wired up. */
+	std::atomic<int32> PendingDependencies{ 1 };
+	std::atomic<bool> bFinished{ false };
+
+	AdaptiveMutex ContinuationLock;
+	std::vector<std::shared_ptr<Task>> Continuations;
+
+	/** Keeps the task alive while it sits in a queue, dropped once it has run. */
+	std::shared_ptr<Task> Self;
+};
+
+typedef std::shared_ptr<Task> TaskHandle;
+
+/**
+* Counts outstanding pieces of work. Add before handing work out, Done when a piece finishes.
+* Wait blocks the calling thread; TaskScheduler::Wait runs other tasks while it waits.
+*/
+class WaitGroup
+{
+public:
+	WaitGroup() = default;
+	DISABLE_COPY_AND_ASSIGN(WaitGroup);
+
+	void Add(int32 Count = 1)
+	{
+		Counter.fetch_add(Count, std::memory_order_relaxed);
+	}
+
+	void Done()
+	{
+		// decrement under the lock, a waiter may destroy the group as soon as it sees zero
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (Counter.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Condition.notify_all();
+		}
+	}
+
+	bool IsDone() const
+	{
+		return Counter.load(std::memory_order_acquire) == 0;
+	}
+
+	void Wait()
+	{
+		std::unique_lock<std::mutex> Lock(Mutex);
+		while (!IsDone())
+		{
+			Condition.wait(Lock);
+		}
+	}
+
+private:
+	std::atomic<int32> Counter{ 0 };
+	std::mutex Mutex;
+	std::condition_variable Condition;
+};
+
+/**
+* Work stealing task scheduler.
+* Every worker thread owns a WorkStealingDeque: tasks spawned from a worker go to the bottom of
+* its own deque and are popped from there (newest first, so the data is still in cache), an idle
+* worker steals the oldest task from a random other worker. Tasks spawned from threads that are
+* not workers go through a shared moodycamel::ConcurrentQueue. Threads blocked in Wait run tasks
+* themselves instead of sleeping, so waiting from inside a task does not deadlock the pool.
+*/
+class Core_API TaskScheduler
+{
+public:
+	/** NumWorkers 0 uses one worker per hardware thread, minus the calling thread. */
+	explicit TaskScheduler(uint32 NumWorkers = 0);
+
+	/** Runs what is still queued, then joins the workers. */
+	~TaskScheduler();
+
+	DISABLE_COPY_AND_ASSIGN(TaskScheduler);
+
+	/** The process wide scheduler, created on first use. */
+	static TaskScheduler& Get();
+
+	TaskHandle Spawn(std::function<void()> Work);
+
+	/** The task runs after every task in Dependencies has finished. Null handles are ignored. */
+	TaskHandle Spawn(std::function<void()> Work, std::initializer_list<TaskHandle> Dependencies);
+	TaskHandle Spawn(std::function<void()> Work, const std::vector<TaskHandle>& Dependencies);
+
+	/** Spawns Work to run after Antecedent has finished. */
+	TaskHandle Then(const TaskHandle& Antecedent, std::function<void()> Work)
+	{
+		return Spawn(std::move(Work), { Antecedent });
+	}
+
+	/** Runs queued tasks on the calling thread until Handle has finished. */
+	void Wait(const TaskHandle& Handle);
+
+	/** Runs queued tasks on the calling thread until Group is done. */
+	void Wait(WaitGroup& Group);
+
+	uint32 GetNumWorkers() const
+	{
+		return static_cast<uint32>(Workers.size());
+	}
+
+private:
+	struct Worker;
+
+	void WorkerMain(Worker* Self);
+	void Enqueue(Task* Ready);
+	bool TryRunOne();
+	void Execute(Task* Ready);
+	void HelpUntil(const std::function<bool()>& IsDone);
+
+	TaskHandle SpawnInternal(std::function<void()>&& Work, const TaskHandle* Dependencies, size_t NumDependencies);
+
+	std::vector<std::unique_ptr<Worker>> Workers;
+	moodycamel::ConcurrentQueue<Task*> InjectionQueue;
+
+	/** Tasks sitting in any queue, sleeping workers wait for this to become non-zero. */
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<int32> NumQueued{ 0 };
+	std::atomic<int32> NumSleeping{ 0 };
+	std::atomic<int32> NumHelping{ 0 };
+	std::atomic<bool> bShutdown{ false };
+
+	std::mutex SleepLock;
+	std::condition_variable SleepCondition;
+	std::mutex CompletionLock;
+	std::condition_variable CompletionCondition;
+};
+
+/**
+* Calls Body(Index) for every Index in [0, Count), spread over the scheduler's workers in chunks
+* of BatchSize. Chunks are claimed from a shared counter, so uneven work balances itself; the
+* calling thread claims chunks too and the call returns when every index has been processed.
+*/
+template<typename BodyType>
+void ParallelFor(uint32 Count, BodyType&& Body, uint32 BatchSize = 1, TaskScheduler& Scheduler = TaskScheduler::Get())
+{
+	if (Count == 0)
+	{
+		return;
+	}
+
+	BatchSize = BatchSize ? BatchSize : 1;
+	const uint32 NumBatches = (Count + BatchSize - 1) / BatchSize;
+	const uint32 NumHelpers = std::min(Scheduler.GetNumWorkers(), NumBatches - 1);
+	if (NumHelpers == 0)
+	{
+		for (uint32 Index = 0; Index < Count; ++Index)
+		{
+			Body(Index);
+		}
+		return;
+	}
+
+	std::atomic<uint32> NextBatch{ 0 };
+	auto RunBatches = [&]()
+	{
+		for (uint32 Batch = NextBatch.fetch_add(1, std::memory_order_relaxed); Batch < NumBatches; Batch = NextBatch.fetch_add(1, std::memory_order_relaxed))
+		{
+			const uint32 End = std::min(Count, (Batch + 1) * BatchSize);
+			for (uint32 Index = Batch * BatchSize; Index < End; ++Index)
+			{
+				Body(Index);
+			}
+		}
+	};
+
+	WaitGroup Group;
+	Group.Add(NumHelpers);
+	for (uint32 Helper = 0; Helper < NumHelpers; ++Helper)
+	{
+		Scheduler.Spawn([&]() { RunBatches(); Group.Done(); });
+	}
+	RunBatches();
+	Scheduler.Wait(Group);
+}
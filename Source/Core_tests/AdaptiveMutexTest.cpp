@@ -0,0 +1,51 @@
+// AdaptiveMutex: mutual exclusion under heavy contention, including threads parked on the
+// futex word, and try_lock failing while another thread holds the lock.
+#include "TestSupport.h"
+
+namespace
+{
+	const uint32 NumThreads = 8;
+	const uint32 LocksPerThread = 100000;
+}
+
+int32 AdaptiveMutexTest()
+{
+	AdaptiveMutex Mutex;
+	{
+		TEST_CHECK(Mutex.try_lock());
+		bool bAcquiredElsewhere = true;
+		std::thread([&]() { bAcquiredElsewhere = Mutex.try_lock(); }).join();
+		TEST_CHECK(!bAcquiredElsewhere);
+		Mutex.unlock();
+		std::thread([&]() { bAcquiredElsewhere = Mutex.try_lock(); }).join();
+		TEST_CHECK(bAcquiredElsewhere);
+		Mutex.unlock();
+	}
+
+	// plain counters, a lost update or two threads inside at once shows up in them
+	uint64 Counter = 0;
+	uint32 Inside = 0;
+	std::atomic<uint32> Overlaps{ 0 };
+	RunThreads(NumThreads, [&](uint32 ThreadIndex)
+	{
+		for (uint32 Index = 0; Index < LocksPerThread; ++Index)
+		{
+			SCOPED_LOCK_GUARD(Mutex);
+			if (Inside++ != 0)
+			{
+				Overlaps.fetch_add(1, std::memory_order_relaxed);
+			}
+			++Counter;
+			// now and then hold the lock long enough for the waiters to park
+			if ((Index + ThreadIndex) % 4096 == 0)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+			--Inside;
+		}
+	});
+
+	TEST_CHECK(Overlaps.load() == 0);
+	TEST_CHECK(Counter == uint64(NumThreads) * LocksPerThread);
+	return 0;
+}
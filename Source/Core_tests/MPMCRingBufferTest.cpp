@@ -0,0 +1,82 @@
+// MPMCRingBuffer: empty requests return at once, and under several producers and consumers
+// every pushed item is popped exactly once.
+#include "TestSupport.h"
+
+namespace
+{
+	const uint32 NumProducers = 4;
+	const uint32 NumConsumers = 4;
+	const uint32 ItemsPerProducer = 200000;
+	const uint32 MaxBatch = 8;
+}
+
+int32 MPMCRingBufferTest()
+{
+	{
+		MPMCRingBuffer<uint32> Ring(4);
+		uint32 Item = 7;
+		TEST_CHECK(Ring.PushBulk(&Item, 0) == 0);
+		TEST_CHECK(Ring.PopBulk(&Item, 0) == 0);
+		TEST_CHECK(Ring.TryPush(Item));
+		// a non-empty ring used to make a zero sized pop spin forever
+		TEST_CHECK(Ring.PopBulk(&Item, 0) == 0);
+		TEST_CHECK(Ring.Size() == 1);
+		while (Ring.TryPush(Item))
+		{
+		}
+		// and a full one a zero sized push
+		TEST_CHECK(Ring.PushBulk(&Item, 0) == 0);
+		TEST_CHECK(Ring.Size() == Ring.Capacity());
+	}
+
+	// small, so producers and consumers keep lapping each other
+	MPMCRingBuffer<uint32> Ring(64);
+	const uint32 NumItems = NumProducers * ItemsPerProducer;
+	DeliveryLog Log(NumItems);
+
+	RunThreads(NumProducers + NumConsumers, [&](uint32 ThreadIndex)
+	{
+		if (ThreadIndex < NumProducers)
+		{
+			// single pushes and bulk pushes of varying size, retried until they fit
+			uint32 Next = ThreadIndex * ItemsPerProducer;
+			const uint32 End = Next + ItemsPerProducer;
+			uint32 Batch[MaxBatch];
+			while (Next < End)
+			{
+				const uint32 Count = std::min(End - Next, (Next % MaxBatch) + 1);
+				for (uint32 Index = 0; Index < Count; ++Index)
+				{
+					Batch[Index] = Next + Index;
+				}
+				const size_t Pushed = Count == 1 ? (Ring.TryPush(Batch[0]) ? 1 : 0) : Ring.PushBulk(Batch, Count);
+				Next += uint32(Pushed);
+				if (!Pushed)
+				{
+					std::this_thread::yield();
+				}
+			}
+			return;
+		}
+
+		uint32 Batch[MaxBatch];
+		uint32 Round = ThreadIndex;
+		while (Log.GetTotal() < NumItems)
+		{
+			const size_t Popped = (++Round & 1) ? (Ring.TryPop(Batch[0]) ? 1 : 0) : Ring.PopBulk(Batch, MaxBatch);
+			for (size_t Index = 0; Index < Popped; ++Index)
+			{
+				Log.Deliver(Batch[Index]);
+			}
+			if (!Popped)
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	TEST_CHECK(Log.GetTotal() == NumItems);
+	TEST_CHECK(Log.IsExactlyOnce("MPMCRingBuffer"));
+	TEST_CHECK(Ring.IsEmpty());
+	return 0;
+}
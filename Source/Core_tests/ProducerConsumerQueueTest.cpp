@@ -0,0 +1,111 @@
+// ProducerConsumerQueue: zero sized bulk pops and a full queue do not block, and blocking
+// producers and consumers hand over every item exactly once before Cancel releases them.
+#include "TestSupport.h"
+
+namespace
+{
+	const uint32 NumProducers = 3;
+	const uint32 NumConsumers = 3;
+	const uint32 ItemsPerProducer = 100000;
+	const uint32 MaxBatch = 16;
+}
+
+int32 ProducerConsumerQueueTest()
+{
+	{
+		ProducerConsumerQueue<uint32> Queue(4);
+		uint32 Items[4] = {};
+		size_t Popped = 1;
+		TEST_CHECK(Queue.WaitAndPopBulkFor(Items, 4, Popped, std::chrono::milliseconds(1)) == EQueueWaitResult::TimedOut);
+		TEST_CHECK(Popped == 0);
+
+		Queue.Push(1);
+		// used to spin forever once an item was queued
+		TEST_CHECK(Queue.WaitAndPopBulk(Items, 0) == 0);
+		TEST_CHECK(Queue.WaitAndPopBulkFor(Items, 0, Popped, std::chrono::seconds(10)) == EQueueWaitResult::Popped);
+		TEST_CHECK(Popped == 0);
+
+		while (Queue.TryPush(2))
+		{
+		}
+		TEST_CHECK(Queue.WaitAndPopBulk(Items, 4) == 4);
+		TEST_CHECK(Items[0] == 1);
+
+		Queue.Cancel();
+		TEST_CHECK(!Queue.TryPush(3));
+		TEST_CHECK(Queue.WaitAndPopBulk(Items, 4) == 0);
+	}
+
+	// smaller than what the producers push, so they block on a full queue as well
+	ProducerConsumerQueue<uint32> Queue(256);
+	const uint32 NumItems = NumProducers * ItemsPerProducer;
+	DeliveryLog Log(NumItems);
+	std::atomic<uint32> NumProducing{ NumProducers };
+
+	RunThreads(NumProducers + NumConsumers + 1, [&](uint32 ThreadIndex)
+	{
+		if (ThreadIndex < NumProducers)
+		{
+			uint32 Next = ThreadIndex * ItemsPerProducer;
+			const uint32 End = Next + ItemsPerProducer;
+			uint32 Batch[MaxBatch];
+			while (Next < End)
+			{
+				const uint32 Count = std::min(End - Next, (Next % MaxBatch) + 1);
+				if (Count == 1)
+				{
+					Queue.Push(Next);
+				}
+				else
+				{
+					for (uint32 Index = 0; Index < Count; ++Index)
+					{
+						Batch[Index] = Next + Index;
+					}
+					Queue.PushBulk(Batch, Count);
+				}
+				Next += Count;
+			}
+			NumProducing.fetch_sub(1);
+			return;
+		}
+
+		if (ThreadIndex == NumProducers + NumConsumers)
+		{
+			// cancels once everything arrived, which must wake the consumers blocked on an empty queue
+			while (NumProducing.load() || Log.GetTotal() < NumItems)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			Queue.Cancel();
+			return;
+		}
+
+		uint32 Batch[MaxBatch];
+		uint32 Round = ThreadIndex;
+		while (true)
+		{
+			size_t Popped = 0;
+			if (++Round & 1)
+			{
+				if (Queue.WaitAndPop(Batch[0]) != EQueueWaitResult::Popped)
+				{
+					break;
+				}
+				Popped = 1;
+			}
+			else if (Queue.WaitAndPopBulkFor(Batch, MaxBatch, Popped, std::chrono::milliseconds(5)) == EQueueWaitResult::Shutdown)
+			{
+				break;
+			}
+			for (size_t Index = 0; Index < Popped; ++Index)
+			{
+				Log.Deliver(Batch[Index]);
+			}
+		}
+	});
+
+	TEST_CHECK(Log.GetTotal() == NumItems);
+	TEST_CHECK(Log.IsExactlyOnce("ProducerConsumerQueue"));
+	return 0;
+}
@@ -0,0 +1,96 @@
+// TaskScheduler: a random dependency graph runs every task once and only after its dependencies,
+// and ParallelFor visits every index once, also when nested in tasks that others depend on.
+#include "TestSupport.h"
+
+namespace
+{
+	const uint32 NumTasks = 2000;
+	const uint32 MaxDependencies = 4;
+	const uint32 ParallelCount = 100000;
+
+	/** xorshift32, the graph only has to be the same on every run. */
+	uint32 NextRandom(uint32& State)
+	{
+		State ^= State << 13;
+		State ^= State >> 17;
+		State ^= State << 5;
+		return State;
+	}
+}
+
+int32 TaskSchedulerTest()
+{
+	TaskScheduler Scheduler(4);
+
+	{
+		// every task depends on up to MaxDependencies earlier ones, picked by a fixed seed
+		uint32 RandomState = 12345;
+		std::vector<TaskHandle> Tasks;
+		Tasks.reserve(NumTasks);
+		DeliveryLog Log(NumTasks);
+		std::atomic<uint32> NumOutOfOrder{ 0 };
+		for (uint32 Index = 0; Index < NumTasks; ++Index)
+		{
+			std::vector<TaskHandle> Dependencies;
+			const uint32 NumDependencies = Index ? NextRandom(RandomState) % (MaxDependencies + 1) : 0;
+			for (uint32 Dependency = 0; Dependency < NumDependencies; ++Dependency)
+			{
+				Dependencies.push_back(Tasks[NextRandom(RandomState) % Index]);
+			}
+			Tasks.push_back(Scheduler.Spawn([&Log, &NumOutOfOrder, Dependencies, Index]()
+			{
+				for (const TaskHandle& Dependency : Dependencies)
+				{
+					if (!Dependency->IsFinished())
+					{
+						NumOutOfOrder.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+				Log.Deliver(Index);
+			}, Dependencies));
+		}
+
+		WaitGroup Group;
+		Group.Add();
+		TaskHandle Last = Scheduler.Then(Tasks.back(), [&]() { Group.Done(); });
+		Scheduler.Wait(Group);
+		for (const TaskHandle& Handle : Tasks)
+		{
+			Scheduler.Wait(Handle);
+		}
+
+		TEST_CHECK(Last->IsFinished());
+		TEST_CHECK(NumOutOfOrder.load() == 0);
+		TEST_CHECK(Log.GetTotal() == NumTasks);
+		TEST_CHECK(Log.IsExactlyOnce("TaskScheduler dependencies"));
+	}
+
+	{
+		DeliveryLog Log(ParallelCount);
+		ParallelFor(ParallelCount, [&](uint32 Index) { Log.Deliver(Index); }, 64, Scheduler);
+		TEST_CHECK(Log.GetTotal() == ParallelCount);
+		TEST_CHECK(Log.IsExactlyOnce("ParallelFor"));
+	}
+
+	{
+		// ParallelFor inside tasks waits by running other tasks, and the join task sees all of it done
+		const uint32 NumOuter = 16;
+		const uint32 InnerCount = 1000;
+		DeliveryLog Log(NumOuter * InnerCount);
+		std::vector<TaskHandle> Outer;
+		for (uint32 OuterIndex = 0; OuterIndex < NumOuter; ++OuterIndex)
+		{
+			Outer.push_back(Scheduler.Spawn([&Log, &Scheduler, OuterIndex]()
+			{
+				ParallelFor(InnerCount, [&](uint32 Index) { Log.Deliver(OuterIndex * InnerCount + Index); }, 16, Scheduler);
+			}));
+		}
+		uint32 SeenByJoin = 0;
+		TaskHandle Join = Scheduler.Spawn([&]() { SeenByJoin = Log.GetTotal(); }, Outer);
+		Scheduler.Wait(Join);
+
+		TEST_CHECK(SeenByJoin == NumOuter * InnerCount);
+		TEST_CHECK(Log.IsExactlyOnce("nested ParallelFor"));
+	}
+	return 0;
+}
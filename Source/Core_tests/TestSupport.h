@@ -0,0 +1,82 @@
+#pragma once
+
+/** Fails the calling test function: reports Condition and returns 1 from it. */
+#define TEST_CHECK(Condition) \
+	do \
+	{ \
+		if (!(Condition)) \
+		{ \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); \
+			return 1; \
+		} \
+	} while (0)
+
+/** Starts Count threads running Body(ThreadIndex) and joins them. */
+template<typename BodyType>
+void RunThreads(uint32 Count, BodyType&& Body)
+{
+	std::vector<std::thread> Threads;
+	Threads.reserve(Count);
+	for (uint32 Index = 0; Index < Count; ++Index)
+	{
+		Threads.emplace_back([&Body, Index]() { Body(Index); });
+	}
+	for (std::thread& Thread : Threads)
+	{
+		Thread.join();
+	}
+}
+
+/** Counts how often every item of [0, Count) was delivered, from any thread. */
+class DeliveryLog
+{
+public:
+	explicit DeliveryLog(uint32 Count)
+		: Deliveries(new std::atomic<uint32>[Count])
+		, NumItems(Count)
+	{
+		for (uint32 Index = 0; Index < Count; ++Index)
+		{
+			Deliveries[Index].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	DISABLE_COPY_AND_ASSIGN(DeliveryLog);
+
+	void Deliver(uint32 Item)
+	{
+		Deliveries[Item].fetch_add(1, std::memory_order_relaxed);
+		Total.fetch_add(1, std::memory_order_release);
+	}
+
+	uint32 GetTotal() const
+	{
+		return Total.load(std::memory_order_acquire);
+	}
+
+	/** True if every item arrived exactly once, otherwise reports the first one that did not. */
+	bool IsExactlyOnce(const char* What) const
+	{
+		for (uint32 Index = 0; Index < NumItems; ++Index)
+		{
+			const uint32 Count = Deliveries[Index].load(std::memory_order_relaxed);
+			if (Count != 1)
+			{
+				fprintf(stderr, "%s: item %u delivered %u times\n", What, Index, Count);
+				return false;
+			}
+		}
+		return true;
+	}
+
+private:
+	std::unique_ptr<std::atomic<uint32>[]> Deliveries;
+	const uint32 NumItems;
+	std::atomic<uint32> Total{ 0 };
+};
+
+int32 MPMCRingBufferTest();
+int32 ProducerConsumerQueueTest();
+int32 WorkStealingDequeTest();
+int32 AdaptiveMutexTest();
+int32 TaskSchedulerTest();
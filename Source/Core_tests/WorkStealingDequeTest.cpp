@@ -0,0 +1,70 @@
+// WorkStealingDeque: the owner pushes and pops while thieves steal, starting from a tiny ring
+// so it grows under them. Every item is taken exactly once, by the owner or by one thief.
+#include "TestSupport.h"
+
+namespace
+{
+	const uint32 NumThieves = 3;
+	const uint32 NumItems = 500000;
+}
+
+int32 WorkStealingDequeTest()
+{
+	{
+		WorkStealingDeque<uint32> Deque(2);
+		uint32 Item = 0;
+		TEST_CHECK(!Deque.Pop(Item));
+		TEST_CHECK(!Deque.Steal(Item));
+		for (uint32 Index = 0; Index < 5; ++Index)
+		{
+			Deque.Push(Index);
+		}
+		TEST_CHECK(Deque.Steal(Item) && Item == 0);
+		TEST_CHECK(Deque.Pop(Item) && Item == 4);
+		TEST_CHECK(Deque.Pop(Item) && Item == 3);
+	}
+
+	WorkStealingDeque<uint32> Deque(2);
+	DeliveryLog Log(NumItems);
+
+	RunThreads(NumThieves + 1, [&](uint32 ThreadIndex)
+	{
+		uint32 Item = 0;
+		if (ThreadIndex == 0)
+		{
+			// the owner: bursts of pushes, each followed by a few pops of its own
+			for (uint32 Next = 0; Next < NumItems;)
+			{
+				const uint32 Burst = std::min(NumItems - Next, 1 + Next % 64);
+				for (uint32 Index = 0; Index < Burst; ++Index)
+				{
+					Deque.Push(Next++);
+				}
+				for (uint32 Index = 0; Index < Burst / 2 && Deque.Pop(Item); ++Index)
+				{
+					Log.Deliver(Item);
+				}
+			}
+			while (Deque.Pop(Item))
+			{
+				Log.Deliver(Item);
+			}
+		}
+
+		while (Log.GetTotal() < NumItems)
+		{
+			if (Deque.Steal(Item))
+			{
+				Log.Deliver(Item);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	TEST_CHECK(Log.GetTotal() == NumItems);
+	TEST_CHECK(Log.IsExactlyOnce("WorkStealingDeque"));
+	return 0;
+}
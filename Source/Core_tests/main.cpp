@@ -0,0 +1,44 @@
+// Runs the Core tests: all of them, or the one named by the first argument.
+#include "TestSupport.h"
+
+namespace
+{
+	struct TestCase
+	{
+		const char* Name;
+		int32 (*Run)();
+	};
+
+	const TestCase TestCases[] = {
+		{ "MPMCRingBuffer", &MPMCRingBufferTest },
+		{ "ProducerConsumerQueue", &ProducerConsumerQueueTest },
+		{ "WorkStealingDeque", &WorkStealingDequeTest },
+		{ "AdaptiveMutex", &AdaptiveMutexTest },
+		{ "TaskScheduler", &TaskSchedulerTest }
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const std::string Selected = argc > 1 ? argv[1] : "";
+
+	int32 Failed = 0;
+	bool bFound = false;
+	for (const TestCase& Test : TestCases)
+	{
+		if (!Selected.empty() && Selected != Test.Name)
+		{
+			continue;
+		}
+		bFound = true;
+		const int32 Result = Test.Run();
+		printf("%s: %s\n", Test.Name, Result ? "FAILED" : "passed");
+		Failed += Result ? 1 : 0;
+	}
+	if (!bFound)
+	{
+		fprintf(stderr, "unknown test %s\n", Selected.c_str());
+		return 1;
+	}
+	return Failed ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+#include "moc_cache.h"
+#include "moc_utils.h"
+#include "moc_output.h"
+#include "moc.h"
+#include "outputrevision.h"
+
+namespace header_tool
+{
+	static bool read_file(const std::string &path, std::string &content)
+	{
+		FILE *file = fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+
+		fseek(file, 0, SEEK_END);
+		const long length = ftell(file);
+		fseek(file, 0, SEEK_SET);
+
+		bool ok = length >= 0;
+		if (ok)
+		{
+			content.resize(length);
+			ok = fread(&content[0], 1, length, file) == size_t(length);
+		}
+		fclose(file);
+		return ok;
+	}
+
+	//! Q_PLUGIN_METADATA(FILE "x.json") splices that file into the generated code, so its path and
+	//! content are part of the key. Included headers need nothing extra, their tokens are in moc.symbols.
+	static uint64 hash_plugin_meta_data_files(const Moc &moc, uint64 hash)
+	{
+		// the FILE is resolved against the header that names it, tracked like Moc::parse does
+		std::vector<std::string> filenames(1, moc.filename);
+		const std::vector<Symbol> &symbols = moc.symbols;
+		for (size_t i = 0; i < symbols.size(); ++i)
+		{
+			switch (symbols[i].token)
+			{
+			case MOC_INCLUDE_BEGIN:
+				filenames.push_back(symbols[i].unquotedLexem());
+				break;
+			case MOC_INCLUDE_END:
+				if (filenames.size() > 1)
+					filenames.pop_back();
+				break;
+			case Q_PLUGIN_METADATA_TOKEN:
+				for (size_t j = i + 1; j + 1 < symbols.size() && symbols[j].token != RPAREN; ++j)
+				{
+					if (symbols[j].token != IDENTIFIER || symbols[j + 1].token != STRING_LITERAL || symbols[j].lexem() != "FILE")
+						continue;
+					const std::string path = moc.pluginMetaDataPath(filenames.back(), symbols[j + 1].unquotedLexem());
+					// a missing file hashes as empty, the parse reports it and nothing is stored
+					std::string content;
+					if (!path.empty())
+						read_file(path, content);
+					hash = fnv1a(path, hash);
+					hash = fnv1a(content, hash);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+		return hash;
+	}
+
+	result_cache::result_cache(const std::string &directory)
+		: directory(directory)
+	{
+	}
+
+	std::string result_cache::key(const Moc &moc, const std::vector<std::string> &options)
+	{
+		uint64 hash = fnv1a_basis;
+		const int revision = mocOutputRevision;
+		hash = fnv1a(&revision, sizeof(revision), hash);
+
+		// Only token kinds and spellings matter for the generated code. Line numbers are left
+		// out on purpose so whitespace and comment edits still hit the cache.
+		for (const Symbol &symbol : moc.symbols)
+		{
+			const int token = symbol.token;
+			hash = fnv1a(&token, sizeof(token), hash);
+			if (symbol.len != size_t(-1))
+				hash = fnv1a(symbol.lex.data() + symbol.from, symbol.len, hash);
+			hash = fnv1a("", 1, hash);
+		}
+
+		// the file name is printed in the header comment and in the default #include
+		hash = fnv1a(moc.filename, hash);
+		hash = fnv1a(&moc.noInclude, sizeof(moc.noInclude), hash);
+		hash = fnv1a(moc.includePath, hash);
+		for (const std::string &include : moc.includeFiles)
+			hash = fnv1a(include, hash);
+		for (const std::string &option : options)
+			hash = fnv1a(option, hash);
+		hash = hash_plugin_meta_data_files(moc, hash);
+
+		char buffer[17];
+		snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)hash);
+		return buffer;
+	}
+
+	std::string result_cache::entry_path(const std::string &key) const
+	{
+		return (std::filesystem::path(directory) / (key + ".moc")).string();
+	}
+
+	bool result_cache::lookup(const std::string &key, std::string &generated) const
+	{
+		return read_file(entry_path(key), generated);
+	}
+
+	bool result_cache::store(const std::string &key, const std::string &generated) const
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(directory, ec);
+
+		// Write next to the entry and rename, so concurrent runs sharing the directory never
+		// observe a partially written entry.
+		const std::string path = entry_path(key);
+		std::string temporary;
+		FILE *file = create_temporary_for(path, true, temporary);
+		if (!file)
+			return false;
+		const bool written = fwrite(generated.data(), 1, generated.size(), file) == generated.size();
+		if (fclose(file) != 0 || !written)
+		{
+			std::filesystem::remove(temporary, ec);
+			return false;
+		}
+		std::filesystem::rename(temporary, path, ec);
+		if (ec)
+		{
+			std::filesystem::remove(temporary, ec);
+			return false;
+		}
+		return true;
+	}
+}
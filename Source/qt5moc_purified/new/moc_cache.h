@@ -0,0 +1,28 @@
+#pragma once
+
+namespace header_tool
+{
+	class Moc;
+
+	//! Content addressed store of generated meta object code.
+	//! Entries are keyed by the fully preprocessed token stream of a header, which covers every
+	//! header it includes, the plugin meta data files it names and every option that influences
+	//! the generated code, so an unchanged header skips parsing and generation.
+	class result_cache
+	{
+	public:
+		explicit result_cache(const std::string &directory);
+
+		//! Builds the key for the preprocessed symbols of moc. options holds any extra command
+		//! line values (e.g. -M meta data) that end up in the generated code.
+		static std::string key(const Moc &moc, const std::vector<std::string> &options);
+
+		bool lookup(const std::string &key, std::string &generated) const;
+		bool store(const std::string &key, const std::string &generated) const;
+
+	private:
+		std::string entry_path(const std::string &key) const;
+
+		std::string directory;
+	};
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <rapidjson/rapidjson.h>
+
+namespace header_tool
+{
+	//! rapidjson SAX handler that encodes the events it receives as CBOR (RFC 7049).
+	//! Objects and arrays use indefinite length encoding, so nothing has to be buffered to
+	//! count members up front and the bytes go straight to the output stream.
+	//! OutputStream is any rapidjson output stream, i.e. it provides Put(char).
+	//! Keys stay text strings. This is not the integer keyed layout of Qt's own CBOR plugin meta
+	//! data, which is why the generator emits it behind a marker of its own.
+	template<typename OutputStream>
+	class cbor_writer
+	{
+	public:
+		typedef char Ch;
+
+		explicit cbor_writer(OutputStream &os)
+			: os(os)
+		{
+		}
+
+		bool Null()
+		{
+			os.Put(char(0xf6));
+			return true;
+		}
+
+		bool Bool(bool b)
+		{
+			os.Put(char(b ? 0xf5 : 0xf4));
+			return true;
+		}
+
+		bool Int(int i)
+		{
+			return Int64(i);
+		}
+
+		bool Uint(unsigned u)
+		{
+			return Uint64(u);
+		}
+
+		bool Int64(int64 i)
+		{
+			if (i < 0)
+				put_head(1, uint64(-(i + 1)));
+			else
+				put_head(0, uint64(i));
+			return true;
+		}
+
+		bool Uint64(uint64 u)
+		{
+			put_head(0, u);
+			return true;
+		}
+
+		bool Double(double d)
+		{
+			uint64 bits;
+			memcpy(&bits, &d, sizeof(bits));
+			os.Put(char(0xfb));
+			put_big_endian(bits, 8);
+			return true;
+		}
+
+		//! Only called when parsing with kParseNumbersAsStringsFlag.
+		bool RawNumber(const Ch *str, rapidjson::SizeType length, bool)
+		{
+			return Double(strtod(std::string(str, length).c_str(), nullptr));
+		}
+
+		bool String(const Ch *str, rapidjson::SizeType length, bool = false)
+		{
+			put_head(3, length);
+			for (rapidjson::SizeType i = 0; i < length; ++i)
+				os.Put(str[i]);
+			return true;
+		}
+
+		bool String(const Ch *str)
+		{
+			return String(str, rapidjson::SizeType(strlen(str)));
+		}
+
+		bool StartObject()
+		{
+			os.Put(char(0xbf));
+			return true;
+		}
+
+		bool Key(const Ch *str, rapidjson::SizeType length, bool = false)
+		{
+			return String(str, length);
+		}
+
+		bool Key(const Ch *str)
+		{
+			return String(str);
+		}
+
+		bool EndObject(rapidjson::SizeType = 0)
+		{
+			os.Put(char(0xff));
+			return true;
+		}
+
+		bool StartArray()
+		{
+			os.Put(char(0x9f));
+			return true;
+		}
+
+		bool EndArray(rapidjson::SizeType = 0)
+		{
+			os.Put(char(0xff));
+			return true;
+		}
+
+	private:
+		//! Writes the initial byte of a data item plus its argument in the shortest form.
+		void put_head(uint8 major, uint64 value)
+		{
+			const uint8 type = uint8(major << 5);
+			if (value < 24)
+				os.Put(char(type | value));
+			else if (value <= 0xff)
+			{
+				os.Put(char(type | 24));
+				put_big_endian(value, 1);
+			}
+			else if (value <= 0xffff)
+			{
+				os.Put(char(type | 25));
+				put_big_endian(value, 2);
+			}
+			else if (value <= 0xffffffff)
+			{
+				os.Put(char(type | 26));
+				put_big_endian(value, 4);
+			}
+			else
+			{
+				os.Put(char(type | 27));
+				put_big_endian(value, 8);
+			}
+		}
+
+		void put_big_endian(uint64 value, int bytes)
+		{
+			while (bytes--)
+				os.Put(char((value >> (bytes * 8)) & 0xff));
+		}
+
+		OutputStream &os;
+	};
+}
@@ -0,0 +1,94 @@
+#include "moc_class_index.h"
+#include "moc_output.h"
+#include "moc_utils.h"
+#include "moc.h"
+
+namespace header_tool
+{
+	// One class per line, "Q" for QObjects and "G" for gadgets:
+	//   Q <name> <qualified name>
+	static const char *const class_index_signature = "moc class index 1";
+
+	static void append_entries(std::string &text, char kind, const std::unordered_map<std::string, std::string> &classes)
+	{
+		// sorted, so the same classes always give the same file
+		std::vector<const std::pair<const std::string, std::string> *> entries;
+		entries.reserve(classes.size());
+		for (const auto &entry : classes)
+			entries.push_back(&entry);
+		std::sort(entries.begin(), entries.end(), [](const auto *a, const auto *b) { return a->first < b->first; });
+
+		for (const auto *entry : entries)
+		{
+			text += kind;
+			text += ' ';
+			text += entry->first;
+			text += ' ';
+			text += entry->second;
+			text += '\n';
+		}
+	}
+
+	bool class_index::load(const std::string &path)
+	{
+		std::ifstream file(path, std::ios::in);
+		std::string line;
+		if (!std::getline(file, line) || line != class_index_signature)
+			return false;
+
+		while (std::getline(file, line))
+		{
+			const size_t name = line.find(' ');
+			const size_t qualified = line.find(' ', name + 1);
+			if (name != 1 || qualified == std::string::npos)
+				continue;
+
+			std::unordered_map<std::string, std::string> *classes = nullptr;
+			if (line[0] == 'Q')
+				classes = &qobjects;
+			else if (line[0] == 'G')
+				classes = &gadgets;
+			else
+				continue;
+			classes->insert_or_assign(line.substr(name + 1, qualified - name - 1), line.substr(qualified + 1));
+		}
+		return true;
+	}
+
+	std::string class_index::serialize() const
+	{
+		std::string text = class_index_signature;
+		text += '\n';
+		append_entries(text, 'Q', qobjects);
+		append_entries(text, 'G', gadgets);
+		return text;
+	}
+
+	bool class_index::save(const std::string &path) const
+	{
+		return write_if_changed(path, serialize());
+	}
+
+	void class_index::add(const std::vector<ClassDef> &classes)
+	{
+		for (const ClassDef &def : classes)
+		{
+			std::unordered_map<std::string, std::string> &classHash = def.hasQObject ? qobjects : gadgets;
+			classHash.insert_or_assign(def.classname, def.qualified);
+			classHash.insert_or_assign(def.qualified, def.qualified);
+		}
+	}
+
+	void class_index::apply(Moc &moc) const
+	{
+		moc.knownQObjectClasses.insert(qobjects.begin(), qobjects.end());
+		moc.knownGadgets.insert(gadgets.begin(), gadgets.end());
+	}
+
+	std::string class_index::key() const
+	{
+		char buffer[17];
+		snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)fnv1a(serialize()));
+		return buffer;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+namespace header_tool
+{
+	class Moc;
+	struct ClassDef;
+
+	//! Project wide record of which classes are QObjects and which are gadgets.
+	//! Moc only knows the classes declared in the headers a translation unit includes, so a
+	//! superclass or property type from any other header is treated as unknown. A batch run
+	//! collects the classes of all its inputs into an index and saves it; later runs load it
+	//! and seed Moc's lookup tables, without preprocessing any extra headers.
+	//! Both the plain and the fully qualified class name map to the qualified name, matching
+	//! Moc::knownQObjectClasses and Moc::knownGadgets.
+	class class_index
+	{
+	public:
+		//! Merges the index saved at path. Returns false if it cannot be read or is not an index.
+		bool load(const std::string &path);
+
+		//! Writes the index to path, leaving the file alone if it is unchanged.
+		bool save(const std::string &path) const;
+
+		//! Records the QObjects and gadgets declared in a parsed header.
+		void add(const std::vector<ClassDef> &classes);
+
+		//! Adds the indexed classes to moc. Classes moc already knows keep their entries, and
+		//! parsing still replaces anything it declares itself.
+		void apply(Moc &moc) const;
+
+		//! Identifies the content for result_cache keys, since the generated code depends on it.
+		std::string key() const;
+
+		bool empty() const
+		{
+			return qobjects.empty() && gadgets.empty();
+		}
+
+	private:
+		std::string serialize() const;
+
+		std::unordered_map<std::string, std::string> qobjects;
+		std::unordered_map<std::string, std::string> gadgets;
+	};
+}
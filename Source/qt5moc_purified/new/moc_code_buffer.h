@@ -0,0 +1,140 @@
+#pragma once
+
+namespace header_tool
+{
+	//! Right aligned decimal number, the equivalent of printf's "%4d".
+	struct padded_int
+	{
+		int64 value;
+		int width;
+	};
+
+	inline padded_int pad(int64 value, int width)
+	{
+		return { value, width };
+	}
+
+	//! Lower case hexadecimal number with at least digits digits, the equivalent of printf's "%.8x".
+	//! Takes 32 bits like printf does, so negative flags print as their meta data word.
+	struct hex_int
+	{
+		uint32 value;
+		int digits;
+	};
+
+	inline hex_int hex(uint32 value, int digits = 1)
+	{
+		return { value, digits };
+	}
+
+	//! Growable buffer the generated code is appended to.
+	//! Everything is rendered into one contiguous string and written out in a single call,
+	//! instead of going through format parsing and stdio locking for every line.
+	class code_buffer
+	{
+	public:
+		code_buffer()
+		{
+			data.reserve(64 * 1024);
+		}
+
+		code_buffer &operator<<(const char *s)
+		{
+			data.append(s);
+			return *this;
+		}
+
+		code_buffer &operator<<(const std::string &s)
+		{
+			data.append(s);
+			return *this;
+		}
+
+		code_buffer &operator<<(std::string_view s)
+		{
+			data.append(s.data(), s.size());
+			return *this;
+		}
+
+		code_buffer &operator<<(char c)
+		{
+			data.push_back(c);
+			return *this;
+		}
+
+		//! Appends any integer other than char, or enumerator, in decimal like printf's "%d".
+		//! Enums must match here: an unscoped one would otherwise convert to char and print as a letter.
+		template<typename T, typename = typename std::enable_if<(std::is_integral<T>::value || std::is_enum<T>::value) && !std::is_same<T, char>::value>::type>
+		code_buffer &operator<<(T value)
+		{
+			typedef typename std::conditional<std::is_enum<T>::value, std::underlying_type<T>, std::enable_if<true, T>>::type::type integer;
+			if (std::is_signed<integer>::value)
+				append_decimal(int64(integer(value)), 0);
+			else
+				append_unsigned(uint64(integer(value)), 0);
+			return *this;
+		}
+
+		code_buffer &operator<<(const padded_int &value)
+		{
+			append_decimal(value.value, value.width);
+			return *this;
+		}
+
+		code_buffer &operator<<(const hex_int &value)
+		{
+			char digits[8];
+			int count = 0;
+			uint32 v = value.value;
+			do
+			{
+				digits[count++] = "0123456789abcdef"[v & 0xf];
+				v >>= 4;
+			} while (v);
+			for (int i = count; i < value.digits; ++i)
+				data.push_back('0');
+			while (count)
+				data.push_back(digits[--count]);
+			return *this;
+		}
+
+		const std::string &str() const
+		{
+			return data;
+		}
+
+		//! Moves the rendered code out, leaving the buffer empty.
+		std::string take()
+		{
+			return std::move(data);
+		}
+
+	private:
+		void append_decimal(int64 value, int width)
+		{
+			if (value < 0)
+				append_unsigned(0 - uint64(value), width, '-');
+			else
+				append_unsigned(uint64(value), width);
+		}
+
+		void append_unsigned(uint64 value, int width, char sign = 0)
+		{
+			char buffer[24];
+			int count = 0;
+			do
+			{
+				buffer[count++] = char('0' + value % 10);
+				value /= 10;
+			} while (value);
+			for (int i = count + (sign ? 1 : 0); i < width; ++i)
+				data.push_back(' ');
+			if (sign)
+				data.push_back(sign);
+			while (count)
+				data.push_back(buffer[--count]);
+		}
+
+		std::string data;
+	};
+}
@@ -0,0 +1,46 @@
+#include "moc_interned_string.h"
+
+namespace header_tool
+{
+	namespace
+	{
+		struct string_pool_shard
+		{
+			AdaptiveMutex mutex; // held for one hash lookup, contention is resolved by spinning
+			// deque never moves its elements, so the views and handles stay valid
+			std::deque<std::string> strings;
+			std::unordered_map<std::string_view, const std::string *> index;
+		};
+
+		const size_t string_pool_shard_count = 16;
+
+		//! Never destroyed, workers may still intern strings while static objects are torn down.
+		string_pool_shard *string_pool()
+		{
+			static string_pool_shard *shards = new string_pool_shard[string_pool_shard_count];
+			return shards;
+		}
+	}
+
+	const std::string &interned_string::empty_string()
+	{
+		static const std::string *empty = new std::string();
+		return *empty;
+	}
+
+	const std::string *interned_string::intern(std::string_view s)
+	{
+		if (s.empty())
+			return &empty_string();
+
+		string_pool_shard &shard = string_pool()[std::hash<std::string_view>()(s) % string_pool_shard_count];
+		SCOPED_LOCK_GUARD(shard.mutex);
+		auto it = shard.index.find(s);
+		if (it != shard.index.end())
+			return it->second;
+
+		const std::string *stored = &shard.strings.emplace_back(s);
+		shard.index.emplace(*stored, stored);
+		return stored;
+	}
+}
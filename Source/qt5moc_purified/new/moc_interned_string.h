@@ -0,0 +1,175 @@
+#pragma once
+
+namespace header_tool
+{
+	//! Immutable handle to a string kept once in a process wide pool.
+	//! The class model repeats the same short identifiers (type names, accessors, "true") in
+	//! every property, function and argument. Each distinct spelling is stored once and a
+	//! handle is a single pointer, so copying a definition copies pointers, and equal handles
+	//! compare by address. Pooled strings live until the process exits.
+	//! The pool is sharded by hash so parsers running on several threads rarely contend.
+	class interned_string
+	{
+	public:
+		typedef std::string::const_iterator const_iterator;
+		static const size_t npos = std::string::npos;
+
+		interned_string()
+			: value(&empty_string())
+		{
+		}
+
+		interned_string(const std::string &s)
+			: value(intern(s))
+		{
+		}
+
+		interned_string(const char *s)
+			: value(intern(s))
+		{
+		}
+
+		interned_string(std::string_view s)
+			: value(intern(s))
+		{
+		}
+
+		const std::string &str() const
+		{
+			return *value;
+		}
+
+		operator const std::string &() const
+		{
+			return *value;
+		}
+
+		bool empty() const
+		{
+			return value->empty();
+		}
+
+		size_t size() const
+		{
+			return value->size();
+		}
+
+		size_t length() const
+		{
+			return value->size();
+		}
+
+		const char *c_str() const
+		{
+			return value->c_str();
+		}
+
+		const char *data() const
+		{
+			return value->data();
+		}
+
+		char operator[](size_t i) const
+		{
+			return (*value)[i];
+		}
+
+		char at(size_t i) const
+		{
+			return value->at(i);
+		}
+
+		char front() const
+		{
+			return value->front();
+		}
+
+		char back() const
+		{
+			return value->back();
+		}
+
+		const_iterator begin() const
+		{
+			return value->begin();
+		}
+
+		const_iterator end() const
+		{
+			return value->end();
+		}
+
+		template<typename T>
+		size_t find(const T &what, size_t pos = 0) const
+		{
+			return value->find(what, pos);
+		}
+
+		template<typename T>
+		size_t rfind(const T &what, size_t pos = npos) const
+		{
+			return value->rfind(what, pos);
+		}
+
+		template<typename T>
+		size_t find_last_of(const T &what, size_t pos = npos) const
+		{
+			return value->find_last_of(what, pos);
+		}
+
+		std::string substr(size_t pos = 0, size_t count = npos) const
+		{
+			return value->substr(pos, count);
+		}
+
+		friend bool operator==(const interned_string &a, const interned_string &b)
+		{
+			return a.value == b.value;
+		}
+
+		friend bool operator!=(const interned_string &a, const interned_string &b)
+		{
+			return a.value != b.value;
+		}
+
+		friend bool operator<(const interned_string &a, const interned_string &b)
+		{
+			return *a.value < *b.value;
+		}
+
+		friend bool operator==(const interned_string &a, const std::string &b) { return *a.value == b; }
+		friend bool operator==(const std::string &a, const interned_string &b) { return a == *b.value; }
+		friend bool operator!=(const interned_string &a, const std::string &b) { return *a.value != b; }
+		friend bool operator!=(const std::string &a, const interned_string &b) { return a != *b.value; }
+		friend bool operator==(const interned_string &a, const char *b) { return *a.value == b; }
+		friend bool operator==(const char *a, const interned_string &b) { return a == *b.value; }
+		friend bool operator!=(const interned_string &a, const char *b) { return *a.value != b; }
+		friend bool operator!=(const char *a, const interned_string &b) { return a != *b.value; }
+
+		friend std::string operator+(const interned_string &a, const std::string &b) { return *a.value + b; }
+		friend std::string operator+(const std::string &a, const interned_string &b) { return a + *b.value; }
+		friend std::string operator+(const interned_string &a, const char *b) { return *a.value + b; }
+		friend std::string operator+(const char *a, const interned_string &b) { return a + *b.value; }
+		friend std::string operator+(const interned_string &a, char b) { return *a.value + b; }
+		friend std::string operator+(char a, const interned_string &b) { return a + *b.value; }
+		friend std::string operator+(const interned_string &a, const interned_string &b) { return *a.value + *b.value; }
+
+	private:
+		static const std::string &empty_string();
+		static const std::string *intern(std::string_view s);
+
+		const std::string *value;
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<header_tool::interned_string>
+	{
+		size_t operator()(const header_tool::interned_string &s) const
+		{
+			return hash<const void *>()(&s.str());
+		}
+	};
+}
@@ -0,0 +1,70 @@
+#include "moc_output.h"
+
+namespace header_tool
+{
+	bool file_equals(const std::string &path, const std::string &content, bool binary)
+	{
+		// same mode on both sides, so the newline translation matches how the output is written
+		FILE *file = fopen(path.c_str(), binary ? "rb" : "r");
+		if (!file)
+			return false;
+
+		char chunk[64 * 1024];
+		size_t offset = 0;
+		bool equal = true;
+		while (equal)
+		{
+			const size_t read = fread(chunk, 1, sizeof(chunk), file);
+			if (read == 0)
+				break;
+			equal = read <= content.size() - offset && memcmp(chunk, content.data() + offset, read) == 0;
+			offset += read;
+		}
+		equal = equal && !ferror(file) && offset == content.size();
+		fclose(file);
+		return equal;
+	}
+
+	bool write_if_changed(const std::string &path, const std::string &content, bool binary)
+	{
+		if (file_equals(path, content, binary))
+			return true;
+
+		std::string temporary;
+		FILE *file = create_temporary_for(path, binary, temporary);
+		if (!file)
+			return false;
+		const bool written = fwrite(content.data(), 1, content.size(), file) == content.size();
+		std::error_code ec;
+		if (fclose(file) != 0 || !written)
+		{
+			std::filesystem::remove(temporary, ec);
+			return false;
+		}
+		std::filesystem::rename(temporary, path, ec);
+		if (ec)
+		{
+			std::filesystem::remove(temporary, ec);
+			return false;
+		}
+		return true;
+	}
+
+	FILE *create_temporary_for(const std::string &path, bool binary, std::string &temporary)
+	{
+		static std::atomic<uint32> sequence{ 0 };
+		const std::string prefix = path + ".tmp" + std::to_string(PlatformProcess::GetCurrentProcessId()) + ".";
+		for (int attempt = 0; attempt < 16; ++attempt)
+		{
+			temporary = prefix + std::to_string(sequence.fetch_add(1, std::memory_order_relaxed));
+			// "x" fails instead of opening a file that already exists
+			FILE *file = fopen(temporary.c_str(), binary ? "wbx" : "wx");
+			if (file)
+				return file;
+			std::error_code ec;
+			if (!std::filesystem::exists(temporary, ec))
+				return nullptr;
+		}
+		return nullptr;
+	}
+}
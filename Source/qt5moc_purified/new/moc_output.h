@@ -0,0 +1,23 @@
+#pragma once
+
+namespace header_tool
+{
+	//! Returns true if the file at path exists and holds exactly content.
+	//! The file is read in fixed size chunks and the comparison stops at the first difference,
+	//! so a changed output is detected without reading it completely.
+	//! Text files are compared after newline translation, binary files byte for byte.
+	bool file_equals(const std::string &path, const std::string &content, bool binary = false);
+
+	//! Replaces the file at path with content unless it already holds exactly that, leaving
+	//! its modification time alone. The new content is written to a temporary file in the same
+	//! directory and renamed over path, so readers never see a partially written file.
+	//! Returns false if the file could not be written.
+	bool write_if_changed(const std::string &path, const std::string &content, bool binary = false);
+
+	//! Creates a new file next to path for content that is then renamed over path, stores its
+	//! name in temporary and returns it open for writing. The name carries the process id and a
+	//! per process counter, and the file is created exclusively, so another writer's temporary is
+	//! never truncated; a name that already exists, left by a crashed run, is skipped for the next.
+	//! Returns null if no file could be created.
+	FILE *create_temporary_for(const std::string &path, bool binary, std::string &temporary);
+}
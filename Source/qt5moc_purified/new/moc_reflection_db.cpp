@@ -0,0 +1,283 @@
+#include "moc_reflection_db.h"
+#include "moc_utils.h"
+#include "moc.h"
+
+namespace header_tool
+{
+	static uint32 name_hash(const char *name, size_t length)
+	{
+		return uint32(fnv1a(name, length));
+	}
+
+	reflection_db_writer::reflection_db_writer()
+	{
+		// offset 0 is the empty string
+		strings.push_back('\0');
+		string_offsets.emplace(std::string(), 0);
+	}
+
+	uint32 reflection_db_writer::intern(const std::string &s)
+	{
+		auto it = string_offsets.emplace(s, uint32(strings.size()));
+		if (it.second)
+			strings.append(s.c_str(), s.size() + 1);
+		return it.first->second;
+	}
+
+	void reflection_db_writer::add(const ClassDef &def)
+	{
+		reflection_db_class c = {};
+		c.name = intern(def.classname);
+		c.qualified = intern(def.qualified);
+		for (const auto &super : def.superclassList)
+		{
+			if (std::get<1>(super) == FunctionDef::Public)
+			{
+				c.super_class = intern(std::get<0>(super));
+				break;
+			}
+		}
+		c.flags = (def.hasQObject ? reflection_db_class::object : 0) | (def.hasQGadget ? reflection_db_class::gadget : 0);
+
+		c.first_function = uint32(functions.size());
+		const std::pair<const std::vector<FunctionDef> *, reflection_db_function::kinds> lists[] = {
+			{ &def.signalList, reflection_db_function::signal },
+			{ &def.slotList, reflection_db_function::slot },
+			{ &def.methodList, reflection_db_function::method },
+			{ &def.constructorList, reflection_db_function::constructor }
+		};
+		for (const auto &list : lists)
+		{
+			for (const FunctionDef &f : *list.first)
+			{
+				reflection_db_function r = {};
+				r.name = intern(f.name);
+				r.return_type = intern(f.normalizedType);
+				r.tag = intern(f.tag);
+				r.kind = list.second;
+				r.access = f.access;
+				r.flags = (f.isConst ? reflection_db_function::is_const : 0)
+					| (f.isStatic ? reflection_db_function::is_static : 0)
+					| (f.isVirtual ? reflection_db_function::is_virtual : 0)
+					| (f.isAbstract ? reflection_db_function::is_abstract : 0)
+					| (f.wasCloned ? reflection_db_function::is_cloned : 0)
+					| (f.isPrivateSignal ? reflection_db_function::is_private_signal : 0)
+					| (f.isCompat ? reflection_db_function::is_compat : 0)
+					| (f.isScriptable ? reflection_db_function::is_scriptable : 0);
+				r.revision = uint32(f.revision);
+				r.first_argument = uint32(arguments.size());
+				r.argument_count = uint32(f.arguments.size());
+				for (const ArgumentDef &a : f.arguments)
+					arguments.push_back({ intern(a.name), intern(a.normalizedType), a.isDefault ? 1u : 0u });
+				functions.push_back(r);
+			}
+		}
+		c.function_count = uint32(functions.size()) - c.first_function;
+
+		c.first_property = uint32(properties.size());
+		c.property_count = uint32(def.propertyList.size());
+		for (const PropertyDef &p : def.propertyList)
+		{
+			reflection_db_property r = {};
+			r.name = intern(p.name);
+			r.type = intern(p.type);
+			r.member = intern(p.member);
+			r.read = intern(p.read);
+			r.write = intern(p.write);
+			r.reset = intern(p.reset);
+			r.notify = intern(p.notify);
+			r.flags = (p.constant ? reflection_db_property::constant : 0) | (p.final ? reflection_db_property::final : 0);
+			r.revision = uint32(p.revision);
+			properties.push_back(r);
+		}
+
+		c.first_enum = uint32(enums.size());
+		c.enum_count = uint32(def.enumList.size());
+		for (const EnumDef &e : def.enumList)
+		{
+			reflection_db_enum r = {};
+			r.name = intern(e.name);
+			auto alias = def.flagAliases.find(e.name);
+			r.flag_alias = alias != def.flagAliases.end() ? intern(alias->second) : 0;
+			r.is_enum_class = e.isEnumClass ? 1 : 0;
+			r.first_value = uint32(enum_values.size());
+			r.value_count = uint32(e.values.size());
+			for (const std::string &value : e.values)
+				enum_values.push_back(intern(value));
+			enums.push_back(r);
+		}
+
+		classes.push_back(c);
+	}
+
+	template<typename T>
+	static void append_table(std::string &image, reflection_db_table &table, const std::vector<T> &records)
+	{
+		table.offset = uint32(image.size());
+		table.count = uint32(records.size());
+		image.append(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(T));
+	}
+
+	std::string reflection_db_writer::finish() const
+	{
+		// Load factor of at most one half keeps probe sequences short.
+		uint32 buckets = 2;
+		while (buckets < classes.size() * 2)
+			buckets *= 2;
+		std::vector<reflection_db_index_entry> index(buckets, reflection_db_index_entry{ 0, reflection_db_none });
+		for (uint32 i = 0; i < classes.size(); ++i)
+		{
+			const char *qualified = strings.data() + classes[i].qualified;
+			const uint32 hash = name_hash(qualified, strlen(qualified));
+			uint32 slot = hash & (buckets - 1);
+			while (index[slot].class_index != reflection_db_none)
+			{
+				// the first class of a name wins, like the first definition would
+				if (index[slot].hash == hash && !strcmp(strings.data() + classes[index[slot].class_index].qualified, qualified))
+					break;
+				slot = (slot + 1) & (buckets - 1);
+			}
+			if (index[slot].class_index == reflection_db_none)
+				index[slot] = { hash, i };
+		}
+
+		reflection_db_header header = {};
+		header.magic = reflection_db_magic;
+		header.version = reflection_db_version;
+
+		std::string image(sizeof(header), '\0');
+		append_table(image, header.classes, classes);
+		append_table(image, header.functions, functions);
+		append_table(image, header.arguments, arguments);
+		append_table(image, header.properties, properties);
+		append_table(image, header.enums, enums);
+		append_table(image, header.enum_values, enum_values);
+		append_table(image, header.index, index);
+		// the pool goes last, its size is not a multiple of four
+		header.strings.offset = uint32(image.size());
+		header.strings.count = uint32(strings.size());
+		image += strings;
+
+		memcpy(&image[0], &header, sizeof(header));
+		return image;
+	}
+
+	bool reflection_db_view::open(const void *image, size_t size)
+	{
+		data = static_cast<const char *>(image);
+		header = reinterpret_cast<const reflection_db_header *>(image);
+		// records are read in place, so the image and every table but the string pool must
+		// sit on a 32-bit boundary
+		if (reinterpret_cast<uintptr_t>(image) % sizeof(uint32) || size < sizeof(reflection_db_header) || header->magic != reflection_db_magic || header->version != reflection_db_version)
+			return false;
+
+		const std::pair<const reflection_db_table *, size_t> tables[] = {
+			{ &header->strings, 1 },
+			{ &header->classes, sizeof(reflection_db_class) },
+			{ &header->functions, sizeof(reflection_db_function) },
+			{ &header->arguments, sizeof(reflection_db_argument) },
+			{ &header->properties, sizeof(reflection_db_property) },
+			{ &header->enums, sizeof(reflection_db_enum) },
+			{ &header->enum_values, sizeof(uint32) },
+			{ &header->index, sizeof(reflection_db_index_entry) }
+		};
+		for (const auto &t : tables)
+		{
+			if (t.first->offset > size || uint64(t.first->count) * t.second > size - t.first->offset
+				|| (t.first != &header->strings && t.first->offset % sizeof(uint32)))
+				return false;
+		}
+		const uint32 buckets = header->index.count;
+		if (!header->strings.count || data[header->strings.offset + header->strings.count - 1] != '\0'
+			|| !buckets || (buckets & (buckets - 1)))
+			return false;
+
+		// The accessors trust the records, so every string offset and record range is checked
+		// here. The pool ends with a terminator, so any offset inside it is a valid string.
+		const uint32 pool = header->strings.count;
+		auto strings_valid = [pool](std::initializer_list<uint32> offsets)
+		{
+			for (uint32 offset : offsets)
+				if (offset >= pool)
+					return false;
+			return true;
+		};
+		auto range_valid = [](uint32 first, uint32 count, const reflection_db_table &t)
+		{
+			return uint64(first) + count <= t.count;
+		};
+
+		const reflection_db_class *classes = table<reflection_db_class>(header->classes);
+		for (uint32 i = 0; i < header->classes.count; ++i)
+		{
+			const reflection_db_class &c = classes[i];
+			if (!strings_valid({ c.name, c.qualified, c.super_class })
+				|| !range_valid(c.first_function, c.function_count, header->functions)
+				|| !range_valid(c.first_property, c.property_count, header->properties)
+				|| !range_valid(c.first_enum, c.enum_count, header->enums))
+				return false;
+		}
+		const reflection_db_function *functions = table<reflection_db_function>(header->functions);
+		for (uint32 i = 0; i < header->functions.count; ++i)
+		{
+			const reflection_db_function &f = functions[i];
+			if (!strings_valid({ f.name, f.return_type, f.tag }) || !range_valid(f.first_argument, f.argument_count, header->arguments))
+				return false;
+		}
+		const reflection_db_argument *arguments = table<reflection_db_argument>(header->arguments);
+		for (uint32 i = 0; i < header->arguments.count; ++i)
+		{
+			if (!strings_valid({ arguments[i].name, arguments[i].type }))
+				return false;
+		}
+		const reflection_db_property *properties = table<reflection_db_property>(header->properties);
+		for (uint32 i = 0; i < header->properties.count; ++i)
+		{
+			const reflection_db_property &p = properties[i];
+			if (!strings_valid({ p.name, p.type, p.member, p.read, p.write, p.reset, p.notify }))
+				return false;
+		}
+		const reflection_db_enum *enums = table<reflection_db_enum>(header->enums);
+		for (uint32 i = 0; i < header->enums.count; ++i)
+		{
+			const reflection_db_enum &e = enums[i];
+			if (!strings_valid({ e.name, e.flag_alias }) || !range_valid(e.first_value, e.value_count, header->enum_values))
+				return false;
+		}
+		const uint32 *enum_values = table<uint32>(header->enum_values);
+		for (uint32 i = 0; i < header->enum_values.count; ++i)
+		{
+			if (!strings_valid({ enum_values[i] }))
+				return false;
+		}
+
+		// find_class probes until it meets an empty slot, so there has to be one
+		const reflection_db_index_entry *index = table<reflection_db_index_entry>(header->index);
+		bool has_empty_slot = false;
+		for (uint32 slot = 0; slot < buckets; ++slot)
+		{
+			if (index[slot].class_index == reflection_db_none)
+				has_empty_slot = true;
+			else if (index[slot].class_index >= header->classes.count)
+				return false;
+		}
+		return has_empty_slot;
+	}
+
+	const reflection_db_class *reflection_db_view::find_class(const char *qualified, size_t length) const
+	{
+		const reflection_db_index_entry *index = table<reflection_db_index_entry>(header->index);
+		const uint32 mask = header->index.count - 1;
+		const uint32 hash = name_hash(qualified, length);
+		for (uint32 slot = hash & mask; index[slot].class_index != reflection_db_none; slot = (slot + 1) & mask)
+		{
+			if (index[slot].hash != hash)
+				continue;
+			const reflection_db_class &c = class_at(index[slot].class_index);
+			const char *name = string(c.qualified);
+			if (!strncmp(name, qualified, length) && name[length] == '\0')
+				return &c;
+		}
+		return nullptr;
+	}
+}
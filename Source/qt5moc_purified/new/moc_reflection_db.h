@@ -0,0 +1,216 @@
+#pragma once
+
+namespace header_tool
+{
+	struct ClassDef;
+
+	//! Layout of the reflection database, a single offset based image that can be memory mapped
+	//! and read in place. All records consist of 32-bit fields in native (little endian) byte
+	//! order, so they need no padding and no decoding. Strings are byte offsets into a pool of
+	//! zero terminated, deduplicated strings; offset 0 is the empty string. Record ranges are
+	//! given as first index plus count into the respective table.
+	const uint32 reflection_db_magic = 0x4244524d; // "MRDB"
+	const uint32 reflection_db_version = 1;
+	const uint32 reflection_db_none = 0xffffffff;
+
+	struct reflection_db_table
+	{
+		uint32 offset;	//!< byte offset from the start of the image
+		uint32 count;	//!< number of records, or bytes for the string pool
+	};
+
+	struct reflection_db_header
+	{
+		uint32 magic;
+		uint32 version;
+		reflection_db_table strings;
+		reflection_db_table classes;
+		reflection_db_table functions;
+		reflection_db_table arguments;
+		reflection_db_table properties;
+		reflection_db_table enums;
+		reflection_db_table enum_values;	//!< string offsets
+		reflection_db_table index;			//!< open addressing hash table, count is a power of two
+	};
+
+	struct reflection_db_class
+	{
+		enum flag_bits
+		{
+			object = 0x1,
+			gadget = 0x2
+		};
+
+		uint32 name;
+		uint32 qualified;
+		uint32 super_class;	//!< first public super class, empty if none
+		uint32 flags;
+		uint32 first_function;
+		uint32 function_count;
+		uint32 first_property;
+		uint32 property_count;
+		uint32 first_enum;
+		uint32 enum_count;
+	};
+
+	struct reflection_db_function
+	{
+		enum kinds
+		{
+			signal,
+			slot,
+			method,
+			constructor
+		};
+
+		enum flag_bits
+		{
+			is_const = 0x1,
+			is_static = 0x2,
+			is_virtual = 0x4,
+			is_abstract = 0x8,
+			is_cloned = 0x10,
+			is_private_signal = 0x20,
+			is_compat = 0x40,
+			is_scriptable = 0x80
+		};
+
+		uint32 name;
+		uint32 return_type;
+		uint32 tag;
+		uint32 kind;
+		uint32 access;	//!< FunctionDef::Access
+		uint32 flags;
+		uint32 revision;
+		uint32 first_argument;
+		uint32 argument_count;
+	};
+
+	struct reflection_db_argument
+	{
+		uint32 name;
+		uint32 type;
+		uint32 is_default;
+	};
+
+	struct reflection_db_property
+	{
+		enum flag_bits
+		{
+			constant = 0x1,
+			final = 0x2
+		};
+
+		uint32 name;
+		uint32 type;
+		uint32 member;
+		uint32 read;
+		uint32 write;
+		uint32 reset;
+		uint32 notify;
+		uint32 flags;
+		uint32 revision;
+	};
+
+	struct reflection_db_enum
+	{
+		uint32 name;
+		uint32 flag_alias;	//!< name of the Q_FLAGS alias, empty if none
+		uint32 is_enum_class;
+		uint32 first_value;
+		uint32 value_count;
+	};
+
+	struct reflection_db_index_entry
+	{
+		uint32 hash;	//!< low 32 bits of the FNV-1a hash of the qualified class name
+		uint32 class_index;	//!< reflection_db_none for an empty slot
+	};
+
+	//! Collects the classes of any number of parsed headers and serializes them into one image.
+	class reflection_db_writer
+	{
+	public:
+		reflection_db_writer();
+
+		void add(const ClassDef &def);
+		void add(const std::vector<ClassDef> &classes)
+		{
+			for (const ClassDef &def : classes)
+				add(def);
+		}
+
+		std::string finish() const;
+
+	private:
+		uint32 intern(const std::string &s);
+
+		std::string strings;
+		std::unordered_map<std::string, uint32> string_offsets;
+		std::vector<reflection_db_class> classes;
+		std::vector<reflection_db_function> functions;
+		std::vector<reflection_db_argument> arguments;
+		std::vector<reflection_db_property> properties;
+		std::vector<reflection_db_enum> enums;
+		std::vector<uint32> enum_values;
+	};
+
+	//! Read only view of a reflection database image, typically a memory mapped file.
+	//! Nothing is copied; returned pointers point into the image.
+	class reflection_db_view
+	{
+	public:
+		//! Validates the header, that every table lies aligned inside the image and that every string
+		//! offset, record range and index entry points into it, so the accessors need no checks.
+		bool open(const void *data, size_t size);
+
+		const reflection_db_class *find_class(const char *qualified, size_t length) const;
+		const reflection_db_class *find_class(const std::string &qualified) const
+		{
+			return find_class(qualified.data(), qualified.size());
+		}
+
+		uint32 class_count() const
+		{
+			return header->classes.count;
+		}
+		const reflection_db_class &class_at(uint32 i) const
+		{
+			return table<reflection_db_class>(header->classes)[i];
+		}
+		const reflection_db_function *functions(const reflection_db_class &c) const
+		{
+			return table<reflection_db_function>(header->functions) + c.first_function;
+		}
+		const reflection_db_argument *arguments(const reflection_db_function &f) const
+		{
+			return table<reflection_db_argument>(header->arguments) + f.first_argument;
+		}
+		const reflection_db_property *properties(const reflection_db_class &c) const
+		{
+			return table<reflection_db_property>(header->properties) + c.first_property;
+		}
+		const reflection_db_enum *enums(const reflection_db_class &c) const
+		{
+			return table<reflection_db_enum>(header->enums) + c.first_enum;
+		}
+		const char *enum_value(const reflection_db_enum &e, uint32 i) const
+		{
+			return string(table<uint32>(header->enum_values)[e.first_value + i]);
+		}
+		const char *string(uint32 offset) const
+		{
+			return data + header->strings.offset + offset;
+		}
+
+	private:
+		template<typename T>
+		const T *table(const reflection_db_table &t) const
+		{
+			return reinterpret_cast<const T *>(data + t.offset);
+		}
+
+		const char *data = nullptr;
+		const reflection_db_header *header = nullptr;
+	};
+}
@@ -0,0 +1,237 @@
+#include "moc_reflection_json.h"
+#include "moc.h"
+#include "outputrevision.h"
+
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace header_tool
+{
+	typedef rapidjson::Writer<rapidjson::StringBuffer> json_writer;
+
+	static void write_string(json_writer &writer, const std::string &s)
+	{
+		writer.String(s.data(), rapidjson::SizeType(s.size()));
+	}
+
+	static void write_member(json_writer &writer, const char *key, const std::string &value)
+	{
+		writer.Key(key);
+		write_string(writer, value);
+	}
+
+	static void write_member(json_writer &writer, const char *key, bool value)
+	{
+		writer.Key(key);
+		writer.Bool(value);
+	}
+
+	static void write_member(json_writer &writer, const char *key, int value)
+	{
+		writer.Key(key);
+		writer.Int(value);
+	}
+
+	static const char *access_name(FunctionDef::Access access)
+	{
+		switch (access)
+		{
+		case FunctionDef::Public: return "public";
+		case FunctionDef::Protected: return "protected";
+		default: return "private";
+		}
+	}
+
+	static void write_functions(json_writer &writer, const char *key, const std::vector<FunctionDef> &functions)
+	{
+		writer.Key(key);
+		writer.StartArray();
+		for (const FunctionDef &f : functions)
+		{
+			writer.StartObject();
+			write_member(writer, "name", f.name);
+			write_member(writer, "returnType", f.normalizedType);
+			writer.Key("access");
+			writer.String(access_name(f.access));
+			if (!f.tag.empty())
+				write_member(writer, "tag", f.tag);
+			if (f.revision > 0)
+				write_member(writer, "revision", f.revision);
+			// flags are only written when set, most functions have none of them
+			if (f.isConst)
+				write_member(writer, "isConst", true);
+			if (f.isStatic)
+				write_member(writer, "isStatic", true);
+			if (f.isVirtual)
+				write_member(writer, "isVirtual", true);
+			if (f.isAbstract)
+				write_member(writer, "isAbstract", true);
+			if (f.isCompat)
+				write_member(writer, "isCompat", true);
+			if (f.wasCloned)
+				write_member(writer, "isCloned", true);
+			if (f.isPrivateSignal)
+				write_member(writer, "isPrivateSignal", true);
+			if (!f.isScriptable)
+				write_member(writer, "isScriptable", false);
+			if (!f.inPrivateClass.empty())
+				write_member(writer, "inPrivateClass", f.inPrivateClass);
+
+			writer.Key("arguments");
+			writer.StartArray();
+			for (const ArgumentDef &a : f.arguments)
+			{
+				writer.StartObject();
+				write_member(writer, "name", a.name);
+				write_member(writer, "type", a.normalizedType);
+				if (a.isDefault)
+					write_member(writer, "isDefault", true);
+				writer.EndObject();
+			}
+			writer.EndArray();
+			writer.EndObject();
+		}
+		writer.EndArray();
+	}
+
+	static void write_properties(json_writer &writer, const std::vector<PropertyDef> &properties)
+	{
+		writer.Key("properties");
+		writer.StartArray();
+		for (const PropertyDef &p : properties)
+		{
+			writer.StartObject();
+			write_member(writer, "name", p.name);
+			write_member(writer, "type", p.type);
+			// accessors and attributes as spelled in Q_PROPERTY, left out when not given
+			const std::pair<const char *, const interned_string *> attributes[] = {
+				{ "member", &p.member }, { "read", &p.read }, { "write", &p.write }, { "reset", &p.reset },
+				{ "notify", &p.notify }, { "designable", &p.designable }, { "scriptable", &p.scriptable },
+				{ "editable", &p.editable }, { "stored", &p.stored }, { "user", &p.user },
+				{ "inPrivateClass", &p.inPrivateClass }
+			};
+			for (const auto &attribute : attributes)
+			{
+				if (!attribute.second->empty())
+					write_member(writer, attribute.first, *attribute.second);
+			}
+			if (p.constant)
+				write_member(writer, "constant", true);
+			if (p.final)
+				write_member(writer, "final", true);
+			if (p.revision > 0)
+				write_member(writer, "revision", p.revision);
+			writer.EndObject();
+		}
+		writer.EndArray();
+	}
+
+	static void write_enums(json_writer &writer, const ClassDef &c)
+	{
+		writer.Key("enums");
+		writer.StartArray();
+		for (const EnumDef &e : c.enumList)
+		{
+			writer.StartObject();
+			write_member(writer, "name", e.name);
+			if (e.isEnumClass)
+				write_member(writer, "isEnumClass", true);
+			auto alias = c.flagAliases.find(e.name);
+			if (alias != c.flagAliases.end())
+				write_member(writer, "flagAlias", alias->second);
+			writer.Key("values");
+			writer.StartArray();
+			for (const std::string &value : e.values)
+				write_string(writer, value);
+			writer.EndArray();
+			writer.EndObject();
+		}
+		writer.EndArray();
+	}
+
+	static void write_class(json_writer &writer, const ClassDef &c)
+	{
+		writer.StartObject();
+		write_member(writer, "className", c.classname);
+		write_member(writer, "qualifiedClassName", c.qualified);
+		write_member(writer, "object", c.hasQObject);
+		write_member(writer, "gadget", c.hasQGadget);
+
+		writer.Key("superClasses");
+		writer.StartArray();
+		for (const auto &super : c.superclassList)
+		{
+			writer.StartObject();
+			write_member(writer, "name", std::get<0>(super));
+			writer.Key("access");
+			writer.String(access_name(std::get<1>(super)));
+			writer.EndObject();
+		}
+		writer.EndArray();
+
+		writer.Key("classInfos");
+		writer.StartArray();
+		for (const ClassInfoDef &info : c.classInfoList)
+		{
+			writer.StartObject();
+			write_member(writer, "name", info.name);
+			write_member(writer, "value", info.value);
+			writer.EndObject();
+		}
+		writer.EndArray();
+
+		writer.Key("interfaces");
+		writer.StartArray();
+		for (const auto &interfaces : c.interfaceList)
+		{
+			for (const ClassDef::Interface &i : interfaces)
+			{
+				writer.StartObject();
+				write_member(writer, "className", i.className);
+				write_member(writer, "id", i.interfaceId);
+				writer.EndObject();
+			}
+		}
+		writer.EndArray();
+
+		write_enums(writer, c);
+		write_properties(writer, c.propertyList);
+		write_functions(writer, "signals", c.signalList);
+		write_functions(writer, "slots", c.slotList);
+		write_functions(writer, "methods", c.methodList);
+		write_functions(writer, "constructors", c.constructorList);
+
+		if (!c.pluginData.iid.empty())
+			write_member(writer, "pluginIid", c.pluginData.iid);
+		writer.EndObject();
+	}
+
+	void write_reflection_json(const Moc &moc, std::string &json)
+	{
+		// Size the buffer up front from the model, so the writer practically never reallocates.
+		size_t estimate = 256;
+		for (const ClassDef &c : moc.classList)
+		{
+			estimate += 512 + 96 * c.propertyList.size() + 64 * c.enumList.size();
+			for (const auto *functions : { &c.signalList, &c.slotList, &c.methodList, &c.constructorList })
+			{
+				for (const FunctionDef &f : *functions)
+					estimate += 96 + 64 * f.arguments.size();
+			}
+		}
+		rapidjson::StringBuffer buffer(nullptr, estimate);
+		json_writer writer(buffer);
+
+		writer.StartObject();
+		write_member(writer, "inputFile", moc.filename);
+		write_member(writer, "outputRevision", int(mocOutputRevision));
+		writer.Key("classes");
+		writer.StartArray();
+		for (const ClassDef &c : moc.classList)
+			write_class(writer, c);
+		writer.EndArray();
+		writer.EndObject();
+
+		json.assign(buffer.GetString(), buffer.GetSize());
+	}
+}
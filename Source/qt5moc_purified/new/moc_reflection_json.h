@@ -0,0 +1,12 @@
+#pragma once
+#include <string>
+
+namespace header_tool
+{
+	class Moc;
+
+	//! Serializes the class model built by Moc::parse (classes, their functions, properties,
+	//! enums and class infos) to JSON for tools that need reflection data without scraping the
+	//! generated C++. json is replaced with the minified document.
+	void write_reflection_json(const Moc &moc, std::string &json);
+}
@@ -0,0 +1,121 @@
+#include "moc_stats.h"
+#include "moc.h"
+
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+namespace header_tool
+{
+	typedef rapidjson::Writer<rapidjson::StringBuffer> json_writer;
+
+	void file_stats::count_classes(const Moc &moc)
+	{
+		classes = moc.classList.size();
+		methods = 0;
+		properties = 0;
+		for (const ClassDef &def : moc.classList)
+		{
+			methods += def.signalList.size() + def.slotList.size() + def.methodList.size();
+			properties += def.propertyList.size();
+		}
+	}
+
+	void file_stats::add(const file_stats &other)
+	{
+		bytes_read += other.bytes_read;
+		lines += other.lines;
+		tokens += other.tokens;
+		includes_opened += other.includes_opened;
+		includes_skipped += other.includes_skipped;
+		macro_definitions += other.macro_definitions;
+		macro_expansions += other.macro_expansions;
+		conditionals += other.conditionals;
+		symbols += other.symbols;
+		cache_hits += other.cache_hits;
+		classes += other.classes;
+		methods += other.methods;
+		properties += other.properties;
+		bytes_emitted += other.bytes_emitted;
+		preprocess.add(other.preprocess);
+		parse.add(other.parse);
+		generate.add(other.generate);
+	}
+
+	static void write_phase(json_writer &writer, const char *key, const phase_time &phase)
+	{
+		writer.Key(key);
+		writer.StartObject();
+		writer.Key("wallSeconds");
+		writer.Double(phase.wall);
+		writer.Key("cpuSeconds");
+		writer.Double(phase.cpu);
+		writer.EndObject();
+	}
+
+	static void write_counters(json_writer &writer, const file_stats &stats)
+	{
+		const std::pair<const char *, uint64_t> counters[] = {
+			{ "bytesRead", stats.bytes_read },
+			{ "lines", stats.lines },
+			{ "tokens", stats.tokens },
+			{ "includesOpened", stats.includes_opened },
+			{ "includesSkipped", stats.includes_skipped },
+			{ "macroDefinitions", stats.macro_definitions },
+			{ "macroExpansions", stats.macro_expansions },
+			{ "conditionals", stats.conditionals },
+			{ "symbols", stats.symbols },
+			{ "cacheHits", stats.cache_hits },
+			{ "classes", stats.classes },
+			{ "methods", stats.methods },
+			{ "properties", stats.properties },
+			{ "bytesEmitted", stats.bytes_emitted },
+		};
+		for (const auto &counter : counters)
+		{
+			writer.Key(counter.first);
+			writer.Uint64(counter.second);
+		}
+
+		writer.Key("phases");
+		writer.StartObject();
+		write_phase(writer, "preprocess", stats.preprocess);
+		write_phase(writer, "parse", stats.parse);
+		write_phase(writer, "generate", stats.generate);
+		writer.EndObject();
+	}
+
+	void write_stats_json(const std::vector<file_stats> &files, const phase_time &total, std::string &json)
+	{
+		file_stats sum;
+		for (const file_stats &stats : files)
+			sum.add(stats);
+
+		rapidjson::StringBuffer buffer;
+		json_writer writer(buffer);
+		writer.StartObject();
+
+		writer.Key("files");
+		writer.StartArray();
+		for (const file_stats &stats : files)
+		{
+			writer.StartObject();
+			writer.Key("file");
+			writer.String(stats.filename.data(), rapidjson::SizeType(stats.filename.size()));
+			write_counters(writer, stats);
+			writer.EndObject();
+		}
+		writer.EndArray();
+
+		writer.Key("total");
+		writer.StartObject();
+		write_counters(writer, sum);
+		writer.EndObject();
+
+		write_phase(writer, "run", total);
+		writer.Key("peakResidentBytes");
+		writer.Uint64(PlatformMemory::GetPeakResidentBytes());
+
+		writer.EndObject();
+		json.assign(buffer.GetString(), buffer.GetSize());
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+namespace header_tool
+{
+	class Moc;
+
+	//! Wall clock and CPU seconds spent in one phase.
+	struct phase_time
+	{
+		double wall = 0;
+		double cpu = 0;
+
+		void add(const phase_time &other)
+		{
+			wall += other.wall;
+			cpu += other.cpu;
+		}
+	};
+
+	//! Counters for one input file, reported by --stats.
+	//! The preprocessor counts into the stats of its own copy, so files processed in
+	//! parallel never share counters; a batch adds them up at the end.
+	struct file_stats
+	{
+		std::string filename;
+
+		// preprocessing, includes counted in
+		uint64_t bytes_read = 0;
+		uint64_t lines = 0;
+		uint64_t tokens = 0;
+		uint64_t includes_opened = 0;
+		uint64_t includes_skipped = 0; // already preprocessed for this file
+		uint64_t macro_definitions = 0;
+		uint64_t macro_expansions = 0;
+		uint64_t conditionals = 0; // #if, #ifdef, #ifndef and #elif evaluations
+
+		// parsing and generation; a --cache-dir hit skips the parse unless an output needs the
+		// class model, classes, methods and properties stay 0 then
+		uint64_t symbols = 0;
+		uint64_t cache_hits = 0;
+		uint64_t classes = 0;
+		uint64_t methods = 0; // signals, slots and invokables
+		uint64_t properties = 0;
+		uint64_t bytes_emitted = 0;
+
+		phase_time preprocess;
+		phase_time parse;
+		phase_time generate;
+
+		//! Takes the class counts from the parsed classes of moc.
+		void count_classes(const Moc &moc);
+
+		void add(const file_stats &other);
+	};
+
+	//! Adds the time from construction to stop() or destruction to a phase.
+	//! CPU time is that of the calling thread.
+	class phase_timer
+	{
+	public:
+		explicit phase_timer(phase_time &phase)
+			: phase(phase)
+			, wall(PlatformTime::Seconds())
+			, cpu(PlatformTime::ThreadCpuSeconds())
+			, running(true)
+		{
+		}
+
+		~phase_timer()
+		{
+			stop();
+		}
+
+		void stop()
+		{
+			if (!running)
+				return;
+			running = false;
+			phase.wall += PlatformTime::Seconds() - wall;
+			phase.cpu += PlatformTime::ThreadCpuSeconds() - cpu;
+		}
+
+	private:
+		phase_time &phase;
+		double wall;
+		double cpu;
+		bool running;
+	};
+
+	//! Writes the --stats report: the counters of every file, their sum, the wall and CPU time
+	//! of the whole run and the peak resident set size.
+	void write_stats_json(const std::vector<file_stats> &files, const phase_time &total, std::string &json);
+}
@@ -0,0 +1,72 @@
+#include "moc_type_classifier.h"
+#include "generator.h"
+
+namespace header_tool
+{
+	type_classifier::type_classifier(const std::vector<std::string> &meta_types, const std::unordered_map<std::string, std::string> &known_qobject_classes)
+		: meta_types(meta_types.begin(), meta_types.end())
+		, known_qobject_classes(known_qobject_classes)
+	{
+	}
+
+	type_class type_classifier::classify(const std::string &type)
+	{
+		auto it = memo.find(type);
+		if (it != memo.end())
+			return it->second;
+
+		// compute may recurse into template arguments, so insert only afterwards
+		const type_class result = compute(type);
+		memo.emplace(type, result);
+		return result;
+	}
+
+	type_class type_classifier::compute(const std::string &type)
+	{
+		if (type.empty())
+			return type_class::unregistered;
+
+		// builtins come first, the generated code never registers them
+		if (isBuiltinType(type))
+			return type_class::builtin;
+
+		if (meta_types.count(type))
+			return type_class::registered;
+
+		if (type.back() == '*')
+		{
+			// known QObjects are stored by class name, without the '*'
+			if (known_qobject_classes.count(type.substr(0, type.size() - 1)))
+				return type_class::qobject_pointer;
+		}
+
+		const size_t open = type.find('<');
+		if (open == std::string::npos || type.back() != '>')
+			return type_class::unregistered;
+		const std::string name = type.substr(0, open);
+
+		for (const char *smartPointer : automaticSmartPointers)
+		{
+			if (name == smartPointer)
+			{
+				const std::string pointee = type.substr(open + 1, type.size() - open - 2);
+				return known_qobject_classes.count(pointee) ? type_class::smart_pointer : type_class::unregistered;
+			}
+		}
+
+		for (const char *oneArgTemplate : automaticOneArgTemplates)
+		{
+			if (name == oneArgTemplate)
+			{
+				const size_t argumentSize = type.size() - open - 1
+					// The closing '>'
+					- 1
+					// templates inside templates have an extra whitespace char to strip.
+					- (type.at(type.size() - 2) == ' ' ? 1 : 0);
+				const type_class argument = classify(type.substr(open + 1, argumentSize));
+				return argument != type_class::unregistered ? type_class::container : type_class::unregistered;
+			}
+		}
+		return type_class::unregistered;
+	}
+}
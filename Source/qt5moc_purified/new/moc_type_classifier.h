@@ -0,0 +1,41 @@
+#pragma once
+
+namespace header_tool
+{
+	//! How the generated code has to treat a normalized type name.
+	enum class type_class
+	{
+		unregistered,
+		builtin,			//!< one of QMetaType's static types
+		registered,			//!< declared with Q_DECLARE_METATYPE
+		qobject_pointer,	//!< pointer to a known QObject subclass
+		smart_pointer,		//!< e.g. QSharedPointer<T> of a known QObject subclass
+		container			//!< e.g. QList<T> of a builtin or registerable T
+	};
+
+	//! Memoizing classifier for the types used by the classes of one moc run.
+	//! Property and argument types repeat a lot across a header, so every distinct spelling is
+	//! classified once and later checks are a single hash lookup.
+	class type_classifier
+	{
+	public:
+		type_classifier(const std::vector<std::string> &meta_types, const std::unordered_map<std::string, std::string> &known_qobject_classes);
+
+		type_class classify(const std::string &type);
+
+		//! Returns true if the generated code registers type automatically, i.e. it is neither
+		//! builtin nor unknown.
+		bool registerable(const std::string &type)
+		{
+			const type_class c = classify(type);
+			return c != type_class::unregistered && c != type_class::builtin;
+		}
+
+	private:
+		type_class compute(const std::string &type);
+
+		std::unordered_set<std::string> meta_types;
+		const std::unordered_map<std::string, std::string> &known_qobject_classes;
+		std::unordered_map<std::string, type_class> memo;
+	};
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+namespace header_tool
+{
+	//! 64-bit FNV-1a offset basis, the starting value of an empty hash.
+	const uint64 fnv1a_basis = 14695981039346656037ull;
+
+	//! Continues a 64-bit FNV-1a hash over size bytes of data.
+	inline uint64 fnv1a(const void *data, size_t size, uint64 hash = fnv1a_basis)
+	{
+		const uint8 *p = static_cast<const uint8 *>(data);
+		while (size--)
+		{
+			hash ^= *p++;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	inline uint64 fnv1a(const std::string &s, uint64 hash = fnv1a_basis)
+	{
+		// hash the terminating zero as well, so "ab" + "c" and "a" + "bc" differ
+		return fnv1a(s.c_str(), s.size() + 1, hash);
+	}
+}
@@ -1,6 +1,11 @@
 #include "generator.h"
 #include "outputrevision.h"
 #include "utils.h"
+
+#include "moc_cbor_writer.h"
+
+#include <rapidjson/reader.h>
+#include <rapidjson/writer.h>
 #if 0
 #include <QtCore/metatype.h>
 #include <QtCore/qjsondocument.h>
@@ -88,8 +93,8 @@ namespace header_tool
 #if 0
 #endif
 
-	Generator::Generator( ClassDef *classDef, const std::vector<std::string> &metaTypes, const std::unordered_map<std::string, std::string> &knownQObjectClasses, const std::unordered_map<std::string, std::string> &knownGadgets, FILE *outfile )
-		: out( outfile ), cdef( classDef ), metaTypes( metaTypes ), knownQObjectClasses( knownQObjectClasses )
+	Generator::Generator( ClassDef *classDef, type_classifier &types, const std::unordered_map<std::string, std::string> &knownQObjectClasses, const std::unordered_map<std::string, std::string> &knownGadgets, code_buffer &outfile )
+		: out( outfile ), cdef( classDef ), types( types ), knownQObjectClasses( knownQObjectClasses )
 		, knownGadgets( knownGadgets )
 	{
 		if ( cdef->superclassList.size() )
@@ -127,13 +132,13 @@ namespace header_tool
 
 	void Generator::strreg( const std::string &s )
 	{
-		if ( std::find(strings.begin(), strings.end(), s ) == strings.end() )
+		if ( stringIndex.emplace( s, int( strings.size() ) ).second )
 			strings.push_back( s );
 	}
-
 	int Generator::stridx( const std::string &s )
 	{
-		int i = std::distance(strings.begin(), std::find(strings.begin(), strings.end(), s ));
+		auto it = stringIndex.find( s );
+		int i = it != stringIndex.end() ? it->second : int( strings.size() );
 		//Q_ASSERT_X( i != -1, Q_FUNC_INFO, "We forgot to register some strings" );
 		return i;
 	}
@@ -151,58 +156,7 @@ namespace header_tool
 
 	bool Generator::registerableMetaType( const std::string &propertyType )
 	{
-		if ( std::find(metaTypes.begin(), metaTypes.end(), propertyType) != metaTypes.end() )
-			return true;
-
-		if ( propertyType.back() == '*' )
-		{
-			std::string objectPointerType = propertyType;
-			// The objects container stores class names, such as 'QState', 'QLabel' etc,
-			// not 'QState*', 'QLabel*'. The propertyType does contain the '*', so we need
-			// to chop it to find the class type in the known QObjects list.
-			objectPointerType.erase( objectPointerType.back(), 1 );
-			if ( knownQObjectClasses.find( objectPointerType ) !=knownQObjectClasses.end() )
-				return true;
-		}
-
-		// TODO
-		static const std::vector<std::string> smartPointers = std::vector<std::string>();
-		/*
-#define STREAM_SMART_POINTER(SMART_POINTER) << #SMART_POINTER
-			QT_FOR_EACH_AUTOMATIC_TEMPLATE_SMART_POINTER( STREAM_SMART_POINTER )
-#undef STREAM_SMART_POINTER
-			;
-		*/
-
-		for ( const std::string &smartPointer : smartPointers )
-		{
-			if ( propertyType.compare(0, smartPointer.length() + 1, (smartPointer + "<")) == 0  && !propertyType.back() == '&' )
-				return knownQObjectClasses.find(sub(propertyType, smartPointer.size() + 1, propertyType.size() - smartPointer.size() - 1 - 1)) != knownQObjectClasses.end();
-		}
-
-		// TODO
-		static const std::vector<std::string> oneArgTemplates = std::vector<std::string>();
-		/*
-#define STREAM_1ARG_TEMPLATE(TEMPLATENAME) << #TEMPLATENAME
-			QT_FOR_EACH_AUTOMATIC_TEMPLATE_1ARG( STREAM_1ARG_TEMPLATE )
-#undef STREAM_1ARG_TEMPLATE
-			;
-		*/
-
-		for ( const std::string &oneArgTemplateType : oneArgTemplates )
-		{
-			if ( propertyType.compare( 0, oneArgTemplateType.length() + 1, (oneArgTemplateType + "<") ) == 0 && propertyType.back() == '>' )
-			{
-				const int argumentSize = propertyType.size() - oneArgTemplateType.size() - 1
-					// The closing '>'
-					- 1
-					// templates inside templates have an extra whitespace char to strip.
-					- (propertyType.at( propertyType.size() - 2 ) == ' ' ? 1 : 0);
-				const std::string templateArg = sub(propertyType, oneArgTemplateType.size() + 1, argumentSize );
-				return isBuiltinType( templateArg ) || registerableMetaType( templateArg );
-			}
-		}
-		return false;
+		return types.registerable( propertyType );
 	}
 
 	/* returns \c true if name and qualifiedName refers to the same name.
@@ -219,6 +173,8 @@ namespace header_tool
 
 	void Generator::generateCode()
 	{
+		PROFILE_SCOPE_DETAIL("Generator::generateCode", cdef->classname);
+		ALLOC_SCOPE("Generator::generateCode");
 		bool isQt = (cdef->classname == "Qt");
 		bool isQObject = (cdef->classname == "QObject");
 		bool isConstructible = !cdef->constructorList.empty();
@@ -226,26 +182,31 @@ namespace header_tool
 		// filter out undeclared enumerators and sets
 		{
 			std::vector<EnumDef> enumList;
-			for ( int i = 0; i < cdef->enumList.size(); ++i )
+			enumList.reserve( cdef->enumList.size() );
+			for ( EnumDef &def : cdef->enumList )
 			{
-				EnumDef def = cdef->enumList.at( i );
-				if ( cdef->enumDeclarations.find( def.name ) != cdef->enumDeclarations.end() )
-				{
-					enumList.push_back(def);
-				}
-				std::string alias = cdef->flagAliases[def.name];
-				if ( cdef->enumDeclarations.find( alias ) != cdef->enumDeclarations.end())
-				{
-					def.name = alias;
-					enumList.push_back(def);
-				}
+				const bool declared = cdef->enumDeclarations.find( def.name ) != cdef->enumDeclarations.end();
+				const auto alias = cdef->flagAliases.find( def.name );
+				const bool aliasDeclared = alias != cdef->flagAliases.end()
+					&& cdef->enumDeclarations.find( alias->second ) != cdef->enumDeclarations.end();
+				if ( declared && aliasDeclared )
+					enumList.push_back( def );
+				if ( declared || aliasDeclared )
+					enumList.push_back( std::move( def ) );
+				if ( aliasDeclared )
+					enumList.back().name = alias->second;
 			}
-			cdef->enumList = enumList;
+			cdef->enumList = std::move( enumList );
 		}
 
 		//
 		// Register all strings used in data section
 		//
+		const size_t functionCount = cdef->signalList.size() + cdef->slotList.size()
+			+ cdef->methodList.size() + cdef->constructorList.size();
+		strings.reserve( 1 + 2 * cdef->classInfoList.size() + 4 * functionCount
+			+ 2 * cdef->propertyList.size() + 4 * cdef->enumList.size() );
+		stringIndex.reserve( strings.capacity() );
 		strreg( cdef->qualified );
 		registerClassInfoStrings();
 		registerFunctionStrings( cdef->signalList );
@@ -262,8 +223,8 @@ namespace header_tool
 		// Build stringdata struct
 		//
 		const int constCharArraySizeLimit = 65535;
-		fprintf( out, "struct qt_meta_stringdata_%s_t {\n", qualifiedClassNameIdentifier.data() );
-		fprintf( out, "    std::stringData data[%d];\n", strings.size() );
+		out << "struct qt_meta_stringdata_" << qualifiedClassNameIdentifier << "_t {\n";
+		out << "    std::stringData data[" << strings.size() << "];\n";
 		{
 			int stringDataLength = 0;
 			int stringDataCounter = 0;
@@ -274,40 +235,38 @@ namespace header_tool
 				if ( stringDataLength / constCharArraySizeLimit )
 				{
 					// save previous stringdata and start computing the next one.
-					fprintf( out, "    char stringdata%d[%d];\n", stringDataCounter++, stringDataLength - thisLength );
+					out << "    char stringdata" << stringDataCounter++ << "[" << stringDataLength - thisLength << "];\n";
 					stringDataLength = thisLength;
 				}
 			}
-			fprintf( out, "    char stringdata%d[%d];\n", stringDataCounter, stringDataLength );
+			out << "    char stringdata" << stringDataCounter << "[" << stringDataLength << "];\n";
 
 		}
-		fprintf( out, "};\n" );
+		out << "};\n";
 
 		// Macro that expands into a std::stringData. The offset member is
 		// calculated from 1) the offset of the actual characters in the
 		// stringdata.stringdata member, and 2) the stringdata.data index of the
 		// std::stringData being defined. This calculation relies on the
 		// std::stringData::data() implementation returning simply "this + offset".
-		fprintf( out, "#define QT_MOC_LITERAL(idx, ofs, len) \\\n"
+		out << "#define QT_MOC_LITERAL(idx, ofs, len) \\\n"
 			"    Q_STATIC_BYTE_ARRAY_DATA_HEADER_INITIALIZER_WITH_OFFSET(len, \\\n"
-			"    qptrdiff(offsetof(qt_meta_stringdata_%s_t, stringdata0) + ofs \\\n"
+			"    qptrdiff(offsetof(qt_meta_stringdata_" << qualifiedClassNameIdentifier << "_t, stringdata0) + ofs \\\n"
 			"        - idx * sizeof(std::stringData)) \\\n"
-			"    )\n",
-			qualifiedClassNameIdentifier.data() );
+			"    )\n";
 
-		fprintf( out, "static const qt_meta_stringdata_%s_t qt_meta_stringdata_%s = {\n",
-			qualifiedClassNameIdentifier.data(), qualifiedClassNameIdentifier.data() );
-		fprintf( out, "    {\n" );
+		out << "static const qt_meta_stringdata_" << qualifiedClassNameIdentifier << "_t qt_meta_stringdata_" << qualifiedClassNameIdentifier << " = {\n";
+		out << "    {\n";
 		{
 			int idx = 0;
 			for ( int i = 0; i < strings.size(); ++i )
 			{
 				const std::string &str = strings.at( i );
-				fprintf( out, "QT_MOC_LITERAL(%d, %d, %d)", i, idx, str.length() );
+				out << "QT_MOC_LITERAL(" << i << ", " << idx << ", " << str.length() << ")";
 				if ( i != strings.size() - 1 )
-					fputc( ',', out );
+					out << ',';
 				const std::string comment = str.length() > 32 ? sub(str, 0, 29 ) + "..." : str;
-				fprintf( out, " // \"%s\"\n", comment.data() );
+				out << " // \"" << comment << "\"\n";
 				idx += str.length() + 1;
 				for ( int j = 0; j < str.length(); ++j )
 				{
@@ -319,13 +278,13 @@ namespace header_tool
 					}
 				}
 			}
-			fprintf( out, "\n    },\n" );
+			out << "\n    },\n";
 		}
 
 		//
 		// Build stringdata array
 		//
-		fprintf( out, "    \"" );
+		out << "    \"";
 		int col = 0;
 		int len = 0;
 		int stringDataLength = 0;
@@ -336,21 +295,21 @@ namespace header_tool
 			stringDataLength += len + 1;
 			if ( stringDataLength >= constCharArraySizeLimit )
 			{
-				fprintf( out, "\",\n    \"" );
+				out << "\",\n    \"";
 				stringDataLength = len + 1;
 				col = 0;
 			}
 			else if ( i )
-				fputs( "\\0", out ); // add \0 at the end of each string
+				out << "\\0"; // add \0 at the end of each string
 
 			if ( col && col + len >= 72 )
 			{
-				fprintf( out, "\"\n    \"" );
+				out << "\"\n    \"";
 				col = 0;
 			}
 			else if ( len && s.at( 0 ) >= '0' && s.at( 0 ) <= '9' )
 			{
-				fprintf( out, "\"\"" );
+				out << "\"\"";
 				len += 2;
 			}
 			int idx = 0;
@@ -359,17 +318,17 @@ namespace header_tool
 				if ( idx > 0 )
 				{
 					col = 0;
-					fprintf( out, "\"\n    \"" );
+					out << "\"\n    \"";
 				}
-				size_t spanLen = std::min( 70ull, s.length() - idx );
+				size_t spanLen = std::min<size_t>( 70, s.length() - idx );
 				// don't cut escape sequences at the end of a line
 				size_t backSlashPos = s.find_last_of( '\\', idx + spanLen - 1 );
-				if ( backSlashPos >= idx )
+				if ( backSlashPos != std::string::npos && backSlashPos >= idx )
 				{
 					int escapeLen = lengthOfEscapeSequence( s, backSlashPos );
 					spanLen = std::max( spanLen, std::min( backSlashPos + escapeLen - idx, s.length() - idx ) );
 				}
-				fprintf( out, "%.*s", spanLen, s.data() + idx );
+				out << std::string_view( s.data() + idx, spanLen );
 				idx += spanLen;
 				col += spanLen;
 			}
@@ -377,8 +336,8 @@ namespace header_tool
 		}
 
 		// Terminate stringdata struct
-		fprintf( out, "\"\n};\n" );
-		fprintf( out, "#undef QT_MOC_LITERAL\n\n" );
+		out << "\"\n};\n";
+		out << "#undef QT_MOC_LITERAL\n\n";
 
 		//
 		// build the data array
@@ -386,16 +345,16 @@ namespace header_tool
 
 		// todo
 		int index = 0;// MetaObjectPrivateFieldCount;
-		fprintf( out, "static const uint32 qt_meta_data_%s[] = {\n", qualifiedClassNameIdentifier.data() );
-		fprintf( out, "\n // content:\n" );
+		out << "static const uint32 qt_meta_data_" << qualifiedClassNameIdentifier << "[] = {\n";
+		out << "\n // content:\n";
 		// todo
-		fprintf( out, "    %4d,       // revision\n", 0 ); // int( QMetaObjectPrivate::OutputRevision ) );
-		fprintf( out, "    %4d,       // classname\n", stridx( cdef->qualified ) );
-		fprintf( out, "    %4d, %4d, // classinfo\n", cdef->classInfoList.size(), cdef->classInfoList.size() ? index : 0 );
+		out << "    " << pad( 0, 4 ) << ",       // revision\n"; // int( QMetaObjectPrivate::OutputRevision ) );
+		out << "    " << pad( stridx( cdef->qualified ), 4 ) << ",       // classname\n";
+		out << "    " << pad( cdef->classInfoList.size(), 4 ) << ", " << pad( cdef->classInfoList.size() ? index : 0, 4 ) << ", // classinfo\n";
 		index += cdef->classInfoList.size() * 2;
 
 		int methodCount = cdef->signalList.size() + cdef->slotList.size() + cdef->methodList.size();
-		fprintf( out, "    %4d, %4d, // methods\n", methodCount, methodCount ? index : 0 );
+		out << "    " << pad( methodCount, 4 ) << ", " << pad( methodCount ? index : 0, 4 ) << ", // methods\n";
 		index += methodCount * 5;
 		if ( cdef->revisionedMethods )
 			index += methodCount;
@@ -408,19 +367,18 @@ namespace header_tool
 			- methodCount // return "parameters" don't have names
 			- cdef->constructorList.size(); // "this" parameters don't have names
 
-		fprintf( out, "    %4d, %4d, // properties\n", cdef->propertyList.size(), cdef->propertyList.size() ? index : 0 );
+		out << "    " << pad( cdef->propertyList.size(), 4 ) << ", " << pad( cdef->propertyList.size() ? index : 0, 4 ) << ", // properties\n";
 		index += cdef->propertyList.size() * 3;
 		if ( cdef->notifyableProperties )
 			index += cdef->propertyList.size();
 		if ( cdef->revisionedProperties )
 			index += cdef->propertyList.size();
-		fprintf( out, "    %4d, %4d, // enums/sets\n", cdef->enumList.size(), cdef->enumList.size() ? index : 0 );
+		out << "    " << pad( cdef->enumList.size(), 4 ) << ", " << pad( cdef->enumList.size() ? index : 0, 4 ) << ", // enums/sets\n";
 
 		int enumsIndex = index;
 		for ( int i = 0; i < cdef->enumList.size(); ++i )
 			index += 4 + (cdef->enumList.at( i ).values.size() * 2);
-		fprintf( out, "    %4d, %4d, // constructors\n", isConstructible ? cdef->constructorList.size() : 0,
-			isConstructible ? index : 0 );
+		out << "    " << pad( isConstructible ? cdef->constructorList.size() : 0, 4 ) << ", " << pad( isConstructible ? index : 0, 4 ) << ", // constructors\n";
 
 		int flags = 0;
 		if ( cdef->hasQGadget )
@@ -431,8 +389,8 @@ namespace header_tool
 			// todo
 			// flags |= PropertyAccessInStaticMetaCall;
 		}
-		fprintf( out, "    %4d,       // flags\n", flags );
-		fprintf( out, "    %4d,       // signalCount\n", cdef->signalList.size() );
+		out << "    " << pad( flags, 4 ) << ",       // flags\n";
+		out << "    " << pad( cdef->signalList.size(), 4 ) << ",       // signalCount\n";
 
 
 		//
@@ -496,7 +454,7 @@ namespace header_tool
 		//
 		// Terminate data array
 		//
-		fprintf( out, "\n       0        // eod\n};\n\n" );
+		out << "\n       0        // eod\n};\n\n";
 
 		//
 		// Generate internal qt_static_metacall() function
@@ -511,8 +469,6 @@ namespace header_tool
 		// Build extra array
 		//
 		std::vector<std::string> extraList;
-		std::unordered_map<std::string, std::string> knownExtraMetaObject = knownGadgets;
-		knownExtraMetaObject.insert( knownQObjectClasses.begin(), knownQObjectClasses.end() );
 
 		for ( int i = 0; i < cdef->propertyList.size(); ++i )
 		{
@@ -527,10 +483,10 @@ namespace header_tool
 			if ( s <= 0 )
 				continue;
 
-			std::string unqualifiedScope = sub(p.type, 0, s );
+			std::string unqualifiedScope = sub(p.type.str(), 0, s );
 
 			// The scope may be a namespace for example, so it's only safe to include scopes that are known QObjects (QTBUG-2151)
-			std::unordered_map<std::string, std::string>::const_iterator scopeIt;
+			std::string scope;
 
 			std::string thisScope = cdef->qualified;
 			do
@@ -538,16 +494,14 @@ namespace header_tool
 				int s = thisScope.find_last_of( "::" );
 				thisScope = sub(thisScope, 0, s );
 				std::string currentScope = thisScope.empty() ? unqualifiedScope : thisScope + "::" + unqualifiedScope;
-				scopeIt = knownExtraMetaObject.find( currentScope );
+				if ( knownGadgets.count( currentScope ) || knownQObjectClasses.count( currentScope ) )
+					scope = std::move( currentScope );
 			}
-			while ( !thisScope.empty() && scopeIt == knownExtraMetaObject.end() );
+			while ( !thisScope.empty() && scope.empty() );
 
-			if ( scopeIt == knownExtraMetaObject.end() )
+			if ( scope.empty() )
 				continue;
 
-			// TODO
-			const std::string &scope = (*scopeIt).first;
-
 			if ( scope == "Qt" )
 				continue;
 			if ( qualifiedNameEquals( cdef->qualified, scope ) )
@@ -575,41 +529,40 @@ namespace header_tool
 
 		if ( !extraList.empty() )
 		{
-			fprintf( out, "static const QMetaObject * const qt_meta_extradata_%s[] = {\n    ", qualifiedClassNameIdentifier.data() );
+			out << "static const QMetaObject * const qt_meta_extradata_" << qualifiedClassNameIdentifier << "[] = {\n    ";
 			for ( int i = 0; i < extraList.size(); ++i )
 			{
-				fprintf( out, "    &%s::staticMetaObject,\n", extraList.at( i ).data() );
+				out << "    &" << extraList.at( i ) << "::staticMetaObject,\n";
 			}
-			fprintf( out, "    nullptr\n};\n\n" );
+			out << "    nullptr\n};\n\n";
 		}
 
 		//
 		// Finally create and initialize the static meta object
 		//
 		if ( isQt )
-			fprintf( out, "const QMetaObject QObject::staticQtMetaObject = {\n" );
+			out << "const QMetaObject QObject::staticQtMetaObject = {\n";
 		else
-			fprintf( out, "const QMetaObject %s::staticMetaObject = {\n", cdef->qualified.data() );
+			out << "const QMetaObject " << cdef->qualified << "::staticMetaObject = {\n";
 
 		if ( isQObject )
-			fprintf( out, "    { nullptr, " );
+			out << "    { nullptr, ";
 		else if ( cdef->superclassList.size() && (!cdef->hasQGadget || knownGadgets.find( purestSuperClass ) != knownGadgets.end()) )
-			fprintf( out, "    { &%s::staticMetaObject, ", purestSuperClass.data() );
+			out << "    { &" << purestSuperClass << "::staticMetaObject, ";
 		else
-			fprintf( out, "    { nullptr, " );
-		fprintf( out, "qt_meta_stringdata_%s.data,\n"
-			"      qt_meta_data_%s, ", qualifiedClassNameIdentifier.data(),
-			qualifiedClassNameIdentifier.data() );
+			out << "    { nullptr, ";
+		out << "qt_meta_stringdata_" << qualifiedClassNameIdentifier << ".data,\n"
+			"      qt_meta_data_" << qualifiedClassNameIdentifier << ", ";
 		if ( hasStaticMetaCall )
-			fprintf( out, " qt_static_metacall, " );
+			out << " qt_static_metacall, ";
 		else
-			fprintf( out, " nullptr, " );
+			out << " nullptr, ";
 
 		if ( extraList.empty() )
-			fprintf( out, "nullptr, " );
+			out << "nullptr, ";
 		else
-			fprintf( out, "qt_meta_extradata_%s, ", qualifiedClassNameIdentifier.data() );
-		fprintf( out, "nullptr}\n};\n\n" );
+			out << "qt_meta_extradata_" << qualifiedClassNameIdentifier << ", ";
+		out << "nullptr}\n};\n\n";
 
 		if ( isQt )
 			return;
@@ -617,47 +570,43 @@ namespace header_tool
 		if ( !cdef->hasQObject )
 			return;
 
-		fprintf( out, "\nconst QMetaObject *%s::metaObject() const\n{\n    return QObject::d_ptr->metaObject ? QObject::d_ptr->dynamicMetaObject() : &staticMetaObject;\n}\n",
-			cdef->qualified.data() );
+		out << "\nconst QMetaObject *" << cdef->qualified << "::metaObject() const\n{\n    return QObject::d_ptr->metaObject ? QObject::d_ptr->dynamicMetaObject() : &staticMetaObject;\n}\n";
 
 		//
 		// Generate smart cast function
 		//
-		fprintf( out, "\nvoid *%s::qt_metacast(const char *_clname)\n{\n", cdef->qualified.data() );
-		fprintf( out, "    if (!_clname) return nullptr;\n" );
-		fprintf( out, "    if (!strcmp(_clname, qt_meta_stringdata_%s.stringdata0))\n"
-			"        return static_cast<void*>(const_cast< %s*>(this));\n",
-			qualifiedClassNameIdentifier.data(), cdef->classname.data() );
+		out << "\nvoid *" << cdef->qualified << "::qt_metacast(const char *_clname)\n{\n";
+		out << "    if (!_clname) return nullptr;\n";
+		out << "    if (!strcmp(_clname, qt_meta_stringdata_" << qualifiedClassNameIdentifier << ".stringdata0))\n"
+			"        return static_cast<void*>(const_cast< " << cdef->classname << "*>(this));\n";
 		for ( int i = 1; i < cdef->superclassList.size(); ++i )
 		{ // for all superclasses but the first one
 			if ( std::get<1>(cdef->superclassList.at( i )) == FunctionDef::Private )
 				continue;
 			const char *cname = std::get<0>(cdef->superclassList.at( i )).data();
-			fprintf( out, "    if (!strcmp(_clname, \"%s\"))\n        return static_cast< %s*>(const_cast< %s*>(this));\n",
-				cname, cname, cdef->classname.data() );
+			out << "    if (!strcmp(_clname, \"" << cname << "\"))\n        return static_cast< " << cname << "*>(const_cast< " << cdef->classname << "*>(this));\n";
 		}
 		for ( int i = 0; i < cdef->interfaceList.size(); ++i )
 		{
 			const std::vector<ClassDef::Interface> &iface = cdef->interfaceList.at( i );
 			for ( int j = 0; j < iface.size(); ++j )
 			{
-				fprintf( out, "    if (!strcmp(_clname, %s))\n        return ", iface.at( j ).interfaceId.data() );
+				out << "    if (!strcmp(_clname, " << iface.at( j ).interfaceId << "))\n        return ";
 				for ( int k = j; k >= 0; --k )
-					fprintf( out, "static_cast< %s*>(", iface.at( k ).className.data() );
-				fprintf( out, "const_cast< %s*>(this)%s;\n",
-					cdef->classname.data(), std::string( j + 1, ')' ).data() );
+					out << "static_cast< " << iface.at( k ).className << "*>(";
+				out << "const_cast< " << cdef->classname << "*>(this)" << std::string( j + 1, ')' ).data() << ";\n";
 			}
 		}
 		if ( !purestSuperClass.empty() && !isQObject )
 		{
 			std::string superClass = purestSuperClass;
-			fprintf( out, "    return %s::qt_metacast(_clname);\n", superClass.data() );
+			out << "    return " << superClass << "::qt_metacast(_clname);\n";
 		}
 		else
 		{
-			fprintf( out, "    return nullptr;\n" );
+			out << "    return nullptr;\n";
 		}
-		fprintf( out, "}\n" );
+		out << "}\n";
 
 		//
 		// Generate internal qt_metacall()  function
@@ -692,12 +641,12 @@ namespace header_tool
 		if ( cdef->classInfoList.empty() )
 			return;
 
-		fprintf( out, "\n // classinfo: key, value\n" );
+		out << "\n // classinfo: key, value\n";
 
 		for ( int i = 0; i < cdef->classInfoList.size(); ++i )
 		{
 			const ClassInfoDef &c = cdef->classInfoList.at( i );
-			fprintf( out, "    %4d, %4d,\n", stridx( c.name ), stridx( c.value ) );
+			out << "    " << pad( stridx( c.name ), 4 ) << ", " << pad( stridx( c.value ), 4 ) << ",\n";
 		}
 	}
 
@@ -727,7 +676,7 @@ namespace header_tool
 	{
 		if ( list.empty() )
 			return;
-		fprintf( out, "\n // %ss: name, argc, parameters, tag, flags\n", functype );
+		out << "\n // " << functype << "s: name, argc, parameters, tag, flags\n";
 
 		for ( int i = 0; i < list.size(); ++i )
 		{
@@ -779,8 +728,7 @@ namespace header_tool
 			}
 
 			int argc = f.arguments.size();
-			fprintf( out, "    %4d, %4d, %4d, %4d, 0x%02x /* %s */,\n",
-				stridx( f.name ), argc, paramsIndex, stridx( f.tag ), flags, comment.data() );
+			out << "    " << pad( stridx( f.name ), 4 ) << ", " << pad( argc, 4 ) << ", " << pad( paramsIndex, 4 ) << ", " << pad( stridx( f.tag ), 4 ) << ", 0x" << hex( flags, 2 ) << " /* " << comment << " */,\n";
 
 			paramsIndex += 1 + argc * 2;
 		}
@@ -789,11 +737,11 @@ namespace header_tool
 	void Generator::generateFunctionRevisions( const std::vector<FunctionDef>& list, const char *functype )
 	{
 		if ( list.size() )
-			fprintf( out, "\n // %ss: revision\n", functype );
+			out << "\n // " << functype << "s: revision\n";
 		for ( int i = 0; i < list.size(); ++i )
 		{
 			const FunctionDef &f = list.at( i );
-			fprintf( out, "    %4d,\n", f.revision );
+			out << "    " << pad( f.revision, 4 ) << ",\n";
 		}
 	}
 
@@ -801,31 +749,31 @@ namespace header_tool
 	{
 		if ( list.empty() )
 			return;
-		fprintf( out, "\n // %ss: parameters\n", functype );
+		out << "\n // " << functype << "s: parameters\n";
 		for ( int i = 0; i < list.size(); ++i )
 		{
 			const FunctionDef &f = list.at( i );
-			fprintf( out, "    " );
+			out << "    ";
 
 			// Types
 			int argsCount = f.arguments.size();
 			for ( int j = -1; j < argsCount; ++j )
 			{
 				if ( j > -1 )
-					fputc( ' ', out );
+					out << ' ';
 				const std::string &typeName = (j < 0) ? f.normalizedType : f.arguments.at( j ).normalizedType;
 				generateTypeInfo( typeName, /*allowEmptyName=*/f.isConstructor );
-				fputc( ',', out );
+				out << ',';
 			}
 
 			// Parameter names
 			for ( int j = 0; j < argsCount; ++j )
 			{
 				const ArgumentDef &arg = f.arguments.at( j );
-				fprintf( out, " %4d,", stridx( arg.name ) );
+				out << " " << pad( stridx( arg.name ), 4 ) << ",";
 			}
 
-			fprintf( out, "\n" );
+			out << "\n";
 		}
 	}
 
@@ -849,13 +797,13 @@ namespace header_tool
 			}
 			if ( valueString )
 			{
-				fprintf( out, "metatype::%s", valueString );
+				out << "metatype::" << valueString;
 			}
 			else
 			{
 				// todo
 				//Q_ASSERT( type != metatype::UnknownType );
-				fprintf( out, "%4d", type );
+				out << pad( type, 4 );
 			}
 		}
 		else
@@ -884,7 +832,7 @@ namespace header_tool
 		//
 
 		if ( cdef->propertyList.size() )
-			fprintf( out, "\n // properties: name, type, flags\n" );
+			out << "\n // properties: name, type, flags\n";
 		for ( int i = 0; i < cdef->propertyList.size(); ++i )
 		{
 			const PropertyDef &p = cdef->propertyList.at( i );
@@ -946,32 +894,30 @@ namespace header_tool
 			if ( p.final )
 				flags |= Final;
 			*/
-			fprintf( out, "    %4d, ", stridx( p.name ) );
+			out << "    " << pad( stridx( p.name ), 4 ) << ", ";
 			generateTypeInfo( p.type );
-			fprintf( out, ", 0x%.8x,\n", flags );
+			out << ", 0x" << hex( flags, 8 ) << ",\n";
 		}
 
 		if ( cdef->notifyableProperties )
 		{
-			fprintf( out, "\n // properties: notify_signal_id\n" );
+			out << "\n // properties: notify_signal_id\n";
 			for ( int i = 0; i < cdef->propertyList.size(); ++i )
 			{
 				const PropertyDef &p = cdef->propertyList.at( i );
 				if ( p.notifyId == -1 )
-					fprintf( out, "    %4d,\n",
-						0 );
+					out << "    " << pad( 0, 4 ) << ",\n";
 				else
-					fprintf( out, "    %4d,\n",
-						p.notifyId );
+					out << "    " << pad( p.notifyId, 4 ) << ",\n";
 			}
 		}
 		if ( cdef->revisionedProperties )
 		{
-			fprintf( out, "\n // properties: revision\n" );
+			out << "\n // properties: revision\n";
 			for ( int i = 0; i < cdef->propertyList.size(); ++i )
 			{
 				const PropertyDef &p = cdef->propertyList.at( i );
-				fprintf( out, "    %4d,\n", p.revision );
+				out << "    " << pad( p.revision, 4 ) << ",\n";
 			}
 		}
 	}
@@ -992,7 +938,7 @@ namespace header_tool
 		if ( cdef->enumDeclarations.empty() )
 			return;
 
-		fprintf( out, "\n // enums: name, flags, count, data\n" );
+		out << "\n // enums: name, flags, count, data\n";
 		index += 4 * cdef->enumList.size();
 		int i;
 		for ( i = 0; i < cdef->enumList.size(); ++i )
@@ -1006,15 +952,11 @@ namespace header_tool
 			if ( e.isEnumClass )
 				flags |= EnumIsScoped;
 				*/
-			fprintf( out, "    %4d, 0x%.1x, %4d, %4d,\n",
-				stridx( e.name ),
-				flags,
-				e.values.size(),
-				index );
+			out << "    " << pad( stridx( e.name ), 4 ) << ", 0x" << hex( flags, 1 ) << ", " << pad( e.values.size(), 4 ) << ", " << pad( index, 4 ) << ",\n";
 			index += e.values.size() * 2;
 		}
 
-		fprintf( out, "\n // enum data: key, value\n" );
+		out << "\n // enum data: key, value\n";
 		for ( i = 0; i < cdef->enumList.size(); ++i )
 		{
 			const EnumDef &e = cdef->enumList.at( i );
@@ -1025,8 +967,7 @@ namespace header_tool
 				if ( e.isEnumClass )
 					code += "::" + e.name;
 				code += "::" + val;
-				fprintf( out, "    %4d, uint(%s),\n",
-					stridx( val ), code.data() );
+				out << "    " << pad( stridx( val ), 4 ) << ", uint(" << code << "),\n";
 			}
 		}
 	}
@@ -1035,13 +976,12 @@ namespace header_tool
 	{
 		bool isQObject = (cdef->classname == "QObject");
 
-		fprintf( out, "\nint %s::qt_metacall(QMetaObject::Call _c, int _id, void **_a)\n{\n",
-			cdef->qualified.data() );
+		out << "\nint " << cdef->qualified << "::qt_metacall(QMetaObject::Call _c, int _id, void **_a)\n{\n";
 
 		if ( !purestSuperClass.empty() && !isQObject )
 		{
 			std::string superClass = purestSuperClass;
-			fprintf( out, "    _id = %s::qt_metacall(_c, _id, _a);\n", superClass.data() );
+			out << "    _id = " << superClass << "::qt_metacall(_c, _id, _a);\n";
 		}
 
 
@@ -1056,27 +996,27 @@ namespace header_tool
 		// unhappy.
 		if ( methodList.size() || cdef->propertyList.size() )
 		{
-			fprintf( out, "    if (_id < 0)\n        return _id;\n" );
+			out << "    if (_id < 0)\n        return _id;\n";
 		}
 
-		fprintf( out, "    " );
+		out << "    ";
 
 		if ( methodList.size() )
 		{
 			needElse = true;
-			fprintf( out, "if (_c == QMetaObject::InvokeMetaMethod) {\n" );
-			fprintf( out, "        if (_id < %d)\n", methodList.size() );
-			fprintf( out, "            qt_static_metacall(this, _c, _id, _a);\n" );
-			fprintf( out, "        _id -= %d;\n    }", methodList.size() );
+			out << "if (_c == QMetaObject::InvokeMetaMethod) {\n";
+			out << "        if (_id < " << methodList.size() << ")\n";
+			out << "            qt_static_metacall(this, _c, _id, _a);\n";
+			out << "        _id -= " << methodList.size() << ";\n    }";
 
-			fprintf( out, " else if (_c == QMetaObject::RegisterMethodArgumentMetaType) {\n" );
-			fprintf( out, "        if (_id < %d)\n", methodList.size() );
+			out << " else if (_c == QMetaObject::RegisterMethodArgumentMetaType) {\n";
+			out << "        if (_id < " << methodList.size() << ")\n";
 
 			if ( methodsWithAutomaticTypesHelper( methodList ).empty() )
-				fprintf( out, "            *reinterpret_cast<int*>(_a[0]) = -1;\n" );
+				out << "            *reinterpret_cast<int*>(_a[0]) = -1;\n";
 			else
-				fprintf( out, "            qt_static_metacall(this, _c, _id, _a);\n" );
-			fprintf( out, "        _id -= %d;\n    }", methodList.size() );
+				out << "            qt_static_metacall(this, _c, _id, _a);\n";
+			out << "        _id -= " << methodList.size() << ";\n    }";
 
 		}
 
@@ -1097,126 +1037,121 @@ namespace header_tool
 				needUser |= p.user.back() == ')';
 			}
 
-			fprintf( out, "\n#ifndef QT_NO_PROPERTIES\n   " );
+			out << "\n#ifndef QT_NO_PROPERTIES\n   ";
 			if ( needElse )
-				fprintf( out, "else " );
-			fprintf( out,
-				"if (_c == QMetaObject::ReadProperty || _c == QMetaObject::WriteProperty\n"
+				out << "else ";
+			out
+				<< "if (_c == QMetaObject::ReadProperty || _c == QMetaObject::WriteProperty\n"
 				"            || _c == QMetaObject::ResetProperty || _c == QMetaObject::RegisterPropertyMetaType) {\n"
 				"        qt_static_metacall(this, _c, _id, _a);\n"
-				"        _id -= %d;\n    }", cdef->propertyList.size() );
+				"        _id -= " << cdef->propertyList.size() << ";\n    }";
 
-			fprintf( out, " else " );
-			fprintf( out, "if (_c == QMetaObject::QueryPropertyDesignable) {\n" );
+			out << " else ";
+			out << "if (_c == QMetaObject::QueryPropertyDesignable) {\n";
 			if ( needDesignable )
 			{
-				fprintf( out, "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n" );
-				fprintf( out, "        switch (_id) {\n" );
+				out << "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n";
+				out << "        switch (_id) {\n";
 				for ( int propindex = 0; propindex < cdef->propertyList.size(); ++propindex )
 				{
 					const PropertyDef &p = cdef->propertyList.at( propindex );
 					if ( !p.designable.back() == ')' )
 						continue;
-					fprintf( out, "        case %d: *_b = %s; break;\n",
-						propindex, p.designable.data() );
+					out << "        case " << propindex << ": *_b = " << p.designable << "; break;\n";
 				}
-				fprintf( out, "        default: break;\n" );
-				fprintf( out, "        }\n" );
+				out << "        default: break;\n";
+				out << "        }\n";
 			}
-			fprintf( out,
-				"        _id -= %d;\n"
-				"    }", cdef->propertyList.size() );
+			out
+				<< "        _id -= " << cdef->propertyList.size() << ";\n"
+				"    }";
 
-			fprintf( out, " else " );
-			fprintf( out, "if (_c == QMetaObject::QueryPropertyScriptable) {\n" );
+			out << " else ";
+			out << "if (_c == QMetaObject::QueryPropertyScriptable) {\n";
 			if ( needScriptable )
 			{
-				fprintf( out, "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n" );
-				fprintf( out, "        switch (_id) {\n" );
+				out << "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n";
+				out << "        switch (_id) {\n";
 				for ( int propindex = 0; propindex < cdef->propertyList.size(); ++propindex )
 				{
 					const PropertyDef &p = cdef->propertyList.at( propindex );
 					if ( !p.scriptable.back() == ')' )
 						continue;
-					fprintf( out, "        case %d: *_b = %s; break;\n",
-						propindex, p.scriptable.data() );
+					out << "        case " << propindex << ": *_b = " << p.scriptable << "; break;\n";
 				}
-				fprintf( out, "        default: break;\n" );
-				fprintf( out, "        }\n" );
+				out << "        default: break;\n";
+				out << "        }\n";
 			}
-			fprintf( out,
-				"        _id -= %d;\n"
-				"    }", cdef->propertyList.size() );
+			out
+				<< "        _id -= " << cdef->propertyList.size() << ";\n"
+				"    }";
 
-			fprintf( out, " else " );
-			fprintf( out, "if (_c == QMetaObject::QueryPropertyStored) {\n" );
+			out << " else ";
+			out << "if (_c == QMetaObject::QueryPropertyStored) {\n";
 			if ( needStored )
 			{
-				fprintf( out, "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n" );
-				fprintf( out, "        switch (_id) {\n" );
+				out << "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n";
+				out << "        switch (_id) {\n";
 				for ( int propindex = 0; propindex < cdef->propertyList.size(); ++propindex )
 				{
 					const PropertyDef &p = cdef->propertyList.at( propindex );
 					if ( !p.stored.back() == ')' )
 						continue;
-					fprintf( out, "        case %d: *_b = %s; break;\n",
-						propindex, p.stored.data() );
+					out << "        case " << propindex << ": *_b = " << p.stored << "; break;\n";
 				}
-				fprintf( out, "        default: break;\n" );
-				fprintf( out, "        }\n" );
+				out << "        default: break;\n";
+				out << "        }\n";
 			}
-			fprintf( out,
-				"        _id -= %d;\n"
-				"    }", cdef->propertyList.size() );
+			out
+				<< "        _id -= " << cdef->propertyList.size() << ";\n"
+				"    }";
 
-			fprintf( out, " else " );
-			fprintf( out, "if (_c == QMetaObject::QueryPropertyEditable) {\n" );
+			out << " else ";
+			out << "if (_c == QMetaObject::QueryPropertyEditable) {\n";
 			if ( needEditable )
 			{
-				fprintf( out, "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n" );
-				fprintf( out, "        switch (_id) {\n" );
+				out << "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n";
+				out << "        switch (_id) {\n";
 				for ( int propindex = 0; propindex < cdef->propertyList.size(); ++propindex )
 				{
 					const PropertyDef &p = cdef->propertyList.at( propindex );
 					if ( !p.editable.back() == ')' )
 						continue;
-					fprintf( out, "        case %d: *_b = %s; break;\n",
-						propindex, p.editable.data() );
+					out << "        case " << propindex << ": *_b = " << p.editable << "; break;\n";
 				}
-				fprintf( out, "        default: break;\n" );
-				fprintf( out, "        }\n" );
+				out << "        default: break;\n";
+				out << "        }\n";
 			}
-			fprintf( out,
-				"        _id -= %d;\n"
-				"    }", cdef->propertyList.size() );
+			out
+				<< "        _id -= " << cdef->propertyList.size() << ";\n"
+				"    }";
 
 
-			fprintf( out, " else " );
-			fprintf( out, "if (_c == QMetaObject::QueryPropertyUser) {\n" );
+			out << " else ";
+			out << "if (_c == QMetaObject::QueryPropertyUser) {\n";
 			if ( needUser )
 			{
-				fprintf( out, "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n" );
-				fprintf( out, "        switch (_id) {\n" );
+				out << "        bool *_b = reinterpret_cast<bool*>(_a[0]);\n";
+				out << "        switch (_id) {\n";
 				for ( int propindex = 0; propindex < cdef->propertyList.size(); ++propindex )
 				{
 					const PropertyDef &p = cdef->propertyList.at( propindex );
 					if ( !p.user.back() == ')' )
 						continue;
-					fprintf( out, "        case %d: *_b = %s; break;\n",
-						propindex, p.user.data() );
+					out << "        case " << propindex << ": *_b = " << p.user << "; break;\n";
 				}
-				fprintf( out, "        default: break;\n" );
-				fprintf( out, "        }\n" );
+				out << "        default: break;\n";
+				out << "        }\n";
 			}
-			fprintf( out,
-				"        _id -= %d;\n"
-				"    }", cdef->propertyList.size() );
+			out
+				<< "        _id -= " << cdef->propertyList.size() << ";\n"
+				"    }";
 
-			fprintf( out, "\n#endif // QT_NO_PROPERTIES" );
+			out << "\n#endif // QT_NO_PROPERTIES";
 		}
 		if ( methodList.size() || cdef->propertyList.size() )
-			fprintf( out, "\n    " );
-		fprintf( out, "return _id;\n}\n" );
+			out << "\n    ";
+		out << "return _id;\n}\n";
 	}
 
 
@@ -1226,7 +1161,7 @@ namespace header_tool
 		for ( int i = 0; i < cdef->propertyList.size(); ++i )
 		{
 			const std::string propertyType = cdef->propertyList.at( i ).type;
-			if ( registerableMetaType( propertyType ) && !isBuiltinType( propertyType ) )
+			if ( registerableMetaType( propertyType ) )
 				automaticPropertyMetaTypes.emplace( propertyType, i );
 		}
 		return automaticPropertyMetaTypes;
@@ -1241,7 +1176,7 @@ namespace header_tool
 			for ( int j = 0; j < f.arguments.size(); ++j )
 			{
 				const std::string argType = f.arguments.at( j ).normalizedType;
-				if ( registerableMetaType( argType ) && !isBuiltinType( argType ) )
+				if ( registerableMetaType( argType ) )
 					methodsWithAutomaticTypes[i].emplace( argType, j );
 			}
 		}
@@ -1250,20 +1185,18 @@ namespace header_tool
 
 	void Generator::generateStaticMetacall()
 	{
-		fprintf( out, "void %s::qt_static_metacall(QObject *_o, QMetaObject::Call _c, int _id, void **_a)\n{\n",
-			cdef->qualified.data() );
+		out << "void " << cdef->qualified << "::qt_static_metacall(QObject *_o, QMetaObject::Call _c, int _id, void **_a)\n{\n";
 
 		bool needElse = false;
 		bool isUsed_a = false;
 
 		if ( !cdef->constructorList.empty() )
 		{
-			fprintf( out, "    if (_c == QMetaObject::CreateInstance) {\n" );
-			fprintf( out, "        switch (_id) {\n" );
+			out << "    if (_c == QMetaObject::CreateInstance) {\n";
+			out << "        switch (_id) {\n";
 			for ( int ctorindex = 0; ctorindex < cdef->constructorList.size(); ++ctorindex )
 			{
-				fprintf( out, "        case %d: { %s *_r = new %s(", ctorindex,
-					cdef->classname.data(), cdef->classname.data() );
+				out << "        case " << ctorindex << ": { " << cdef->classname << " *_r = new " << cdef->classname << "(";
 				const FunctionDef &f = cdef->constructorList.at( ctorindex );
 				int offset = 1;
 
@@ -1272,22 +1205,21 @@ namespace header_tool
 				{
 					const ArgumentDef &a = f.arguments.at( j );
 					if ( j )
-						fprintf( out, "," );
-					fprintf( out, "(*reinterpret_cast< %s>(_a[%d]))", a.typeNameForCast.data(), offset++ );
+						out << ",";
+					out << "(*reinterpret_cast< " << a.typeNameForCast << ">(_a[" << offset++ << "]))";
 				}
 				if ( f.isPrivateSignal )
 				{
 					if ( argsCount > 0 )
-						fprintf( out, ", " );
-					fprintf( out, "%s", std::string( "QPrivateSignal()" ).data() );
+						out << ", ";
+					out << std::string( "QPrivateSignal()" ).data();
 				}
-				fprintf( out, ");\n" );
-				fprintf( out, "            if (_a[0]) *reinterpret_cast<%s**>(_a[0]) = _r; } break;\n",
-					cdef->hasQGadget ? "void" : "QObject" );
+				out << ");\n";
+				out << "            if (_a[0]) *reinterpret_cast<" << (cdef->hasQGadget ? "void" : "QObject") << "**>(_a[0]) = _r; } break;\n";
 			}
-			fprintf( out, "        default: break;\n" );
-			fprintf( out, "        }\n" );
-			fprintf( out, "    }" );
+			out << "        default: break;\n";
+			out << "        }\n";
+			out << "    }";
 			needElse = true;
 			isUsed_a = true;
 		}
@@ -1300,35 +1232,35 @@ namespace header_tool
 		if ( !methodList.empty() )
 		{
 			if ( needElse )
-				fprintf( out, " else " );
+				out << " else ";
 			else
-				fprintf( out, "    " );
-			fprintf( out, "if (_c == QMetaObject::InvokeMetaMethod) {\n" );
+				out << "    ";
+			out << "if (_c == QMetaObject::InvokeMetaMethod) {\n";
 			if ( cdef->hasQObject )
 			{
 #ifndef QT_NO_DEBUG
-				fprintf( out, "        Q_ASSERT(staticMetaObject.cast(_o));\n" );
+				out << "        Q_ASSERT(staticMetaObject.cast(_o));\n";
 #endif
-				fprintf( out, "        %s *_t = static_cast<%s *>(_o);\n", cdef->classname.data(), cdef->classname.data() );
+				out << "        " << cdef->classname << " *_t = static_cast<" << cdef->classname << " *>(_o);\n";
 			}
 			else
 			{
-				fprintf( out, "        %s *_t = reinterpret_cast<%s *>(_o);\n", cdef->classname.data(), cdef->classname.data() );
+				out << "        " << cdef->classname << " *_t = reinterpret_cast<" << cdef->classname << " *>(_o);\n";
 			}
-			fprintf( out, "        Q_UNUSED(_t)\n" );
-			fprintf( out, "        switch (_id) {\n" );
+			out << "        Q_UNUSED(_t)\n";
+			out << "        switch (_id) {\n";
 			for ( int methodindex = 0; methodindex < methodList.size(); ++methodindex )
 			{
 				const FunctionDef &f = methodList.at( methodindex );
 				// TODO
 				//Q_ASSERT( !f.normalizedType.empty() );
-				fprintf( out, "        case %d: ", methodindex );
+				out << "        case " << methodindex << ": ";
 				if ( f.normalizedType != "void" )
-					fprintf( out, "{ %s _r = ", noRef( f.normalizedType ).data() );
-				fprintf( out, "_t->" );
+					out << "{ " << noRef( f.normalizedType ) << " _r = ";
+				out << "_t->";
 				if ( f.inPrivateClass.size() )
-					fprintf( out, "%s->", f.inPrivateClass.data() );
-				fprintf( out, "%s(", f.name.data() );
+					out << f.inPrivateClass << "->";
+				out << f.name << "(";
 				int offset = 1;
 
 				int argsCount = f.arguments.size();
@@ -1336,59 +1268,58 @@ namespace header_tool
 				{
 					const ArgumentDef &a = f.arguments.at( j );
 					if ( j )
-						fprintf( out, "," );
-					fprintf( out, "(*reinterpret_cast< %s>(_a[%d]))", a.typeNameForCast.data(), offset++ );
+						out << ",";
+					out << "(*reinterpret_cast< " << a.typeNameForCast << ">(_a[" << offset++ << "]))";
 					isUsed_a = true;
 				}
 				if ( f.isPrivateSignal )
 				{
 					if ( argsCount > 0 )
-						fprintf( out, ", " );
-					fprintf( out, "%s", "QPrivateSignal()" );
+						out << ", ";
+					out << "QPrivateSignal()";
 				}
-				fprintf( out, ");" );
+				out << ");";
 				if ( f.normalizedType != "void" )
 				{
-					fprintf( out, "\n            if (_a[0]) *reinterpret_cast< %s*>(_a[0]) = std::move(_r); } ",
-						noRef( f.normalizedType ).data() );
+					out << "\n            if (_a[0]) *reinterpret_cast< " << noRef( f.normalizedType ) << "*>(_a[0]) = std::move(_r); } ";
 					isUsed_a = true;
 				}
-				fprintf( out, " break;\n" );
+				out << " break;\n";
 			}
-			fprintf( out, "        default: ;\n" );
-			fprintf( out, "        }\n" );
-			fprintf( out, "    }" );
+			out << "        default: ;\n";
+			out << "        }\n";
+			out << "    }";
 			needElse = true;
 
 			std::map<int, std::multimap<std::string, int> > methodsWithAutomaticTypes = methodsWithAutomaticTypesHelper( methodList );
 
 			if ( !methodsWithAutomaticTypes.empty() )
 			{
-				fprintf( out, " else if (_c == QMetaObject::RegisterMethodArgumentMetaType) {\n" );
-				fprintf( out, "        switch (_id) {\n" );
-				fprintf( out, "        default: *reinterpret_cast<int*>(_a[0]) = -1; break;\n" );
+				out << " else if (_c == QMetaObject::RegisterMethodArgumentMetaType) {\n";
+				out << "        switch (_id) {\n";
+				out << "        default: *reinterpret_cast<int*>(_a[0]) = -1; break;\n";
 				std::map<int, std::multimap<std::string, int> >::const_iterator it = methodsWithAutomaticTypes.begin();
 				const std::map<int, std::multimap<std::string, int> >::const_iterator end = methodsWithAutomaticTypes.end();
 				for ( ; it != end; ++it )
 				{
-					fprintf( out, "        case %d:\n", it->first );
-					fprintf( out, "            switch (*reinterpret_cast<int*>(_a[1])) {\n" );
-					fprintf( out, "            default: *reinterpret_cast<int*>(_a[0]) = -1; break;\n" );
+					out << "        case " << it->first << ":\n";
+					out << "            switch (*reinterpret_cast<int*>(_a[1])) {\n";
+					out << "            default: *reinterpret_cast<int*>(_a[0]) = -1; break;\n";
 					auto jt = (it->second).begin();
 					const auto jend = (it->second).end();
 					while ( jt != jend )
 					{
-						fprintf( out, "            case %d:\n", jt->second );
+						out << "            case " << jt->second << ":\n";
 						const std::string &lastKey = jt->first;
 						++jt;
 						if ( jt == jend || jt->first != lastKey )
-							fprintf( out, "                *reinterpret_cast<int*>(_a[0]) = qRegisterMetaType< %s >(); break;\n", lastKey.data() );
+							out << "                *reinterpret_cast<int*>(_a[0]) = qRegisterMetaType< " << lastKey << " >(); break;\n";
 					}
-					fprintf( out, "            }\n" );
-					fprintf( out, "            break;\n" );
+					out << "            }\n";
+					out << "            break;\n";
 				}
-				fprintf( out, "        }\n" );
-				fprintf( out, "    }" );
+				out << "        }\n";
+				out << "    }";
 				isUsed_a = true;
 			}
 
@@ -1397,9 +1328,9 @@ namespace header_tool
 		{
 			// TODO
 			//Q_ASSERT( needElse ); // if there is signal, there was method.
-			fprintf( out, " else if (_c == QMetaObject::IndexOfMethod) {\n" );
-			fprintf( out, "        int *result = reinterpret_cast<int *>(_a[0]);\n" );
-			fprintf( out, "        void **func = reinterpret_cast<void **>(_a[1]);\n" );
+			out << " else if (_c == QMetaObject::IndexOfMethod) {\n";
+			out << "        int *result = reinterpret_cast<int *>(_a[0]);\n";
+			out << "        void **func = reinterpret_cast<void **>(_a[1]);\n";
 			bool anythingUsed = false;
 			for ( int methodindex = 0; methodindex < cdef->signalList.size(); ++methodindex )
 			{
@@ -1407,36 +1338,35 @@ namespace header_tool
 				if ( f.wasCloned || !f.inPrivateClass.empty() || f.isStatic )
 					continue;
 				anythingUsed = true;
-				fprintf( out, "        {\n" );
-				fprintf( out, "            typedef %s (%s::*_t)(", f.type.rawName.data(), cdef->classname.data() );
+				out << "        {\n";
+				out << "            typedef " << f.type.rawName << " (" << cdef->classname << "::*_t)(";
 
 				int argsCount = f.arguments.size();
 				for ( int j = 0; j < argsCount; ++j )
 				{
 					const ArgumentDef &a = f.arguments.at( j );
 					if ( j )
-						fprintf( out, ", " );
-					fprintf( out, "%s", std::string( a.type.name + ' ' + a.rightType ).data() );
+						out << ", ";
+					out << std::string( a.type.name + ' ' + a.rightType );
 				}
 				if ( f.isPrivateSignal )
 				{
 					if ( argsCount > 0 )
-						fprintf( out, ", " );
-					fprintf( out, "%s", "QPrivateSignal" );
+						out << ", ";
+					out << "QPrivateSignal";
 				}
 				if ( f.isConst )
-					fprintf( out, ") const;\n" );
+					out << ") const;\n";
 				else
-					fprintf( out, ");\n" );
-				fprintf( out, "            if (*reinterpret_cast<_t *>(func) == static_cast<_t>(&%s::%s)) {\n",
-					cdef->classname.data(), f.name.data() );
-				fprintf( out, "                *result = %d;\n", methodindex );
-				fprintf( out, "                return;\n" );
-				fprintf( out, "            }\n        }\n" );
+					out << ");\n";
+				out << "            if (*reinterpret_cast<_t *>(func) == static_cast<_t>(&" << cdef->classname << "::" << f.name << ")) {\n";
+				out << "                *result = " << methodindex << ";\n";
+				out << "                return;\n";
+				out << "            }\n        }\n";
 			}
 			if ( !anythingUsed )
-				fprintf( out, "        Q_UNUSED(result);\n        Q_UNUSED(func);\n" );
-			fprintf( out, "    }" );
+				out << "        Q_UNUSED(result);\n        Q_UNUSED(func);\n";
+			out << "    }";
 			needElse = true;
 		}
 
@@ -1445,24 +1375,24 @@ namespace header_tool
 		if ( !automaticPropertyMetaTypes.empty() )
 		{
 			if ( needElse )
-				fprintf( out, " else " );
+				out << " else ";
 			else
-				fprintf( out, "    " );
-			fprintf( out, "if (_c == QMetaObject::RegisterPropertyMetaType) {\n" );
-			fprintf( out, "        switch (_id) {\n" );
-			fprintf( out, "        default: *reinterpret_cast<int*>(_a[0]) = -1; break;\n" );
+				out << "    ";
+			out << "if (_c == QMetaObject::RegisterPropertyMetaType) {\n";
+			out << "        switch (_id) {\n";
+			out << "        default: *reinterpret_cast<int*>(_a[0]) = -1; break;\n";
 			auto it = automaticPropertyMetaTypes.begin();
 			const auto end = automaticPropertyMetaTypes.end();
 			while ( it != end )
 			{
-				fprintf( out, "        case %d:\n", it->second );
+				out << "        case " << it->second << ":\n";
 				const std::string &lastKey = it->first;
 				++it;
 				if ( it == end || it->first != lastKey )
-					fprintf( out, "            *reinterpret_cast<int*>(_a[0]) = qRegisterMetaType< %s >(); break;\n", lastKey.data() );
+					out << "            *reinterpret_cast<int*>(_a[0]) = qRegisterMetaType< " << lastKey << " >(); break;\n";
 			}
-			fprintf( out, "        }\n" );
-			fprintf( out, "    }\n" );
+			out << "        }\n";
+			out << "    }\n";
 			isUsed_a = true;
 			needElse = true;
 		}
@@ -1484,28 +1414,28 @@ namespace header_tool
 				needSet |= !p.write.empty() || (!p.member.empty() && !p.constant);
 				needReset |= !p.reset.empty();
 			}
-			fprintf( out, "\n#ifndef QT_NO_PROPERTIES\n    " );
+			out << "\n#ifndef QT_NO_PROPERTIES\n    ";
 
 			if ( needElse )
-				fprintf( out, "else " );
-			fprintf( out, "if (_c == QMetaObject::ReadProperty) {\n" );
+				out << "else ";
+			out << "if (_c == QMetaObject::ReadProperty) {\n";
 			if ( needGet )
 			{
 				if ( cdef->hasQObject )
 				{
 #ifndef QT_NO_DEBUG
-					fprintf( out, "        Q_ASSERT(staticMetaObject.cast(_o));\n" );
+					out << "        Q_ASSERT(staticMetaObject.cast(_o));\n";
 #endif
-					fprintf( out, "        %s *_t = static_cast<%s *>(_o);\n", cdef->classname.data(), cdef->classname.data() );
+					out << "        " << cdef->classname << " *_t = static_cast<" << cdef->classname << " *>(_o);\n";
 				}
 				else
 				{
-					fprintf( out, "        %s *_t = reinterpret_cast<%s *>(_o);\n", cdef->classname.data(), cdef->classname.data() );
+					out << "        " << cdef->classname << " *_t = reinterpret_cast<" << cdef->classname << " *>(_o);\n";
 				}
-				fprintf( out, "        Q_UNUSED(_t)\n" );
+				out << "        Q_UNUSED(_t)\n";
 				if ( needTempVarForGet )
-					fprintf( out, "        void *_v = _a[0];\n" );
-				fprintf( out, "        switch (_id) {\n" );
+					out << "        void *_v = _a[0];\n";
+				out << "        switch (_id) {\n";
 				for ( int propindex = 0; propindex < cdef->propertyList.size(); ++propindex )
 				{
 					const PropertyDef &p = cdef->propertyList.at( propindex );
@@ -1517,46 +1447,41 @@ namespace header_tool
 						prefix += p.inPrivateClass + "->";
 					}
 					if ( p.gspec == PropertyDef::PointerSpec )
-						fprintf( out, "        case %d: _a[0] = const_cast<void*>(reinterpret_cast<const void*>(%s%s())); break;\n",
-							propindex, prefix.data(), p.read.data() );
+						out << "        case " << propindex << ": _a[0] = const_cast<void*>(reinterpret_cast<const void*>(" << prefix << p.read << "())); break;\n";
 					else if ( p.gspec == PropertyDef::ReferenceSpec )
-						fprintf( out, "        case %d: _a[0] = const_cast<void*>(reinterpret_cast<const void*>(&%s%s())); break;\n",
-							propindex, prefix.data(), p.read.data() );
+						out << "        case " << propindex << ": _a[0] = const_cast<void*>(reinterpret_cast<const void*>(&" << prefix << p.read << "())); break;\n";
 					else if ( cdef->enumDeclarations.find(p.type) != cdef->enumDeclarations.end() ? cdef->enumDeclarations[p.type] : false )
-						fprintf( out, "        case %d: *reinterpret_cast<int*>(_v) = QFlag(%s%s()); break;\n",
-							propindex, prefix.data(), p.read.data() );
+						out << "        case " << propindex << ": *reinterpret_cast<int*>(_v) = QFlag(" << prefix << p.read << "()); break;\n";
 					else if ( !p.read.empty() )
-						fprintf( out, "        case %d: *reinterpret_cast< %s*>(_v) = %s%s(); break;\n",
-							propindex, p.type.data(), prefix.data(), p.read.data() );
+						out << "        case " << propindex << ": *reinterpret_cast< " << p.type << "*>(_v) = " << prefix << p.read << "(); break;\n";
 					else
-						fprintf( out, "        case %d: *reinterpret_cast< %s*>(_v) = %s%s; break;\n",
-							propindex, p.type.data(), prefix.data(), p.member.data() );
+						out << "        case " << propindex << ": *reinterpret_cast< " << p.type << "*>(_v) = " << prefix << p.member << "; break;\n";
 				}
-				fprintf( out, "        default: break;\n" );
-				fprintf( out, "        }\n" );
+				out << "        default: break;\n";
+				out << "        }\n";
 			}
 
-			fprintf( out, "    }" );
+			out << "    }";
 
-			fprintf( out, " else " );
-			fprintf( out, "if (_c == QMetaObject::WriteProperty) {\n" );
+			out << " else ";
+			out << "if (_c == QMetaObject::WriteProperty) {\n";
 
 			if ( needSet )
 			{
 				if ( cdef->hasQObject )
 				{
 #ifndef QT_NO_DEBUG
-					fprintf( out, "        Q_ASSERT(staticMetaObject.cast(_o));\n" );
+					out << "        Q_ASSERT(staticMetaObject.cast(_o));\n";
 #endif
-					fprintf( out, "        %s *_t = static_cast<%s *>(_o);\n", cdef->classname.data(), cdef->classname.data() );
+					out << "        " << cdef->classname << " *_t = static_cast<" << cdef->classname << " *>(_o);\n";
 				}
 				else
 				{
-					fprintf( out, "        %s *_t = reinterpret_cast<%s *>(_o);\n", cdef->classname.data(), cdef->classname.data() );
+					out << "        " << cdef->classname << " *_t = reinterpret_cast<" << cdef->classname << " *>(_o);\n";
 				}
-				fprintf( out, "        Q_UNUSED(_t)\n" );
-				fprintf( out, "        void *_v = _a[0];\n" );
-				fprintf( out, "        switch (_id) {\n" );
+				out << "        Q_UNUSED(_t)\n";
+				out << "        void *_v = _a[0];\n";
+				out << "        switch (_id) {\n";
 				for ( int propindex = 0; propindex < cdef->propertyList.size(); ++propindex )
 				{
 					const PropertyDef &p = cdef->propertyList.at( propindex );
@@ -1571,57 +1496,52 @@ namespace header_tool
 					}
 					if ( cdef->enumDeclarations.find( p.type ) != cdef->enumDeclarations.end() ? cdef->enumDeclarations[p.type] : false )
 					{
-						fprintf( out, "        case %d: %s%s(QFlag(*reinterpret_cast<int*>(_v))); break;\n",
-							propindex, prefix.data(), p.write.data() );
+						out << "        case " << propindex << ": " << prefix << p.write << "(QFlag(*reinterpret_cast<int*>(_v))); break;\n";
 					}
 					else if ( !p.write.empty() )
 					{
-						fprintf( out, "        case %d: %s%s(*reinterpret_cast< %s*>(_v)); break;\n",
-							propindex, prefix.data(), p.write.data(), p.type.data() );
+						out << "        case " << propindex << ": " << prefix << p.write << "(*reinterpret_cast< " << p.type << "*>(_v)); break;\n";
 					}
 					else
 					{
-						fprintf( out, "        case %d:\n", propindex );
-						fprintf( out, "            if (%s%s != *reinterpret_cast< %s*>(_v)) {\n",
-							prefix.data(), p.member.data(), p.type.data() );
-						fprintf( out, "                %s%s = *reinterpret_cast< %s*>(_v);\n",
-							prefix.data(), p.member.data(), p.type.data() );
+						out << "        case " << propindex << ":\n";
+						out << "            if (" << prefix << p.member << " != *reinterpret_cast< " << p.type << "*>(_v)) {\n";
+						out << "                " << prefix << p.member << " = *reinterpret_cast< " << p.type << "*>(_v);\n";
 						if ( !p.notify.empty() && p.notifyId != -1 )
 						{
 							const FunctionDef &f = cdef->signalList.at( p.notifyId );
 							if ( f.arguments.size() == 0 )
-								fprintf( out, "                Q_EMIT _t->%s();\n", p.notify.data() );
+								out << "                Q_EMIT _t->" << p.notify << "();\n";
 							else if ( f.arguments.size() == 1 && f.arguments.at( 0 ).normalizedType == p.type )
-								fprintf( out, "                Q_EMIT _t->%s(%s%s);\n",
-									p.notify.data(), prefix.data(), p.member.data() );
+								out << "                Q_EMIT _t->" << p.notify << "(" << prefix << p.member << ");\n";
 						}
-						fprintf( out, "            }\n" );
-						fprintf( out, "            break;\n" );
+						out << "            }\n";
+						out << "            break;\n";
 					}
 				}
-				fprintf( out, "        default: break;\n" );
-				fprintf( out, "        }\n" );
+				out << "        default: break;\n";
+				out << "        }\n";
 			}
 
-			fprintf( out, "    }" );
+			out << "    }";
 
-			fprintf( out, " else " );
-			fprintf( out, "if (_c == QMetaObject::ResetProperty) {\n" );
+			out << " else ";
+			out << "if (_c == QMetaObject::ResetProperty) {\n";
 			if ( needReset )
 			{
 				if ( cdef->hasQObject )
 				{
 #ifndef QT_NO_DEBUG
-					fprintf( out, "        Q_ASSERT(staticMetaObject.cast(_o));\n" );
+					out << "        Q_ASSERT(staticMetaObject.cast(_o));\n";
 #endif
-					fprintf( out, "        %s *_t = static_cast<%s *>(_o);\n", cdef->classname.data(), cdef->classname.data() );
+					out << "        " << cdef->classname << " *_t = static_cast<" << cdef->classname << " *>(_o);\n";
 				}
 				else
 				{
-					fprintf( out, "        %s *_t = reinterpret_cast<%s *>(_o);\n", cdef->classname.data(), cdef->classname.data() );
+					out << "        " << cdef->classname << " *_t = reinterpret_cast<" << cdef->classname << " *>(_o);\n";
 				}
-				fprintf( out, "        Q_UNUSED(_t)\n" );
-				fprintf( out, "        switch (_id) {\n" );
+				out << "        Q_UNUSED(_t)\n";
+				out << "        switch (_id) {\n";
 				for ( int propindex = 0; propindex < cdef->propertyList.size(); ++propindex )
 				{
 					const PropertyDef &p = cdef->propertyList.at( propindex );
@@ -1632,41 +1552,39 @@ namespace header_tool
 					{
 						prefix += p.inPrivateClass + "->";
 					}
-					fprintf( out, "        case %d: %s%s; break;\n",
-						propindex, prefix.data(), p.reset.data() );
+					out << "        case " << propindex << ": " << prefix << p.reset << "; break;\n";
 				}
-				fprintf( out, "        default: break;\n" );
-				fprintf( out, "        }\n" );
+				out << "        default: break;\n";
+				out << "        }\n";
 			}
-			fprintf( out, "    }" );
-			fprintf( out, "\n#endif // QT_NO_PROPERTIES" );
+			out << "    }";
+			out << "\n#endif // QT_NO_PROPERTIES";
 			needElse = true;
 		}
 
 		if ( needElse )
-			fprintf( out, "\n" );
+			out << "\n";
 
 		if ( methodList.empty() )
 		{
-			fprintf( out, "    Q_UNUSED(_o);\n" );
+			out << "    Q_UNUSED(_o);\n";
 			if ( cdef->constructorList.empty() && automaticPropertyMetaTypes.empty() && methodsWithAutomaticTypesHelper( methodList ).empty() )
 			{
-				fprintf( out, "    Q_UNUSED(_id);\n" );
-				fprintf( out, "    Q_UNUSED(_c);\n" );
+				out << "    Q_UNUSED(_id);\n";
+				out << "    Q_UNUSED(_c);\n";
 			}
 		}
 		if ( !isUsed_a )
-			fprintf( out, "    Q_UNUSED(_a);\n" );
+			out << "    Q_UNUSED(_a);\n";
 
-		fprintf( out, "}\n\n" );
+		out << "}\n\n";
 	}
 
 	void Generator::generateSignal( FunctionDef *def, int index )
 	{
 		if ( def->wasCloned || def->isAbstract )
 			return;
-		fprintf( out, "\n// SIGNAL %d\n%s %s::%s(",
-			index, def->type.name.data(), cdef->qualified.data(), def->name.data() );
+		out << "\n// SIGNAL " << index << "\n" << def->type.name << " " << cdef->qualified << "::" << def->name << "(";
 
 		std::string thisPtr = "this";
 		const char *constQualifier = "";
@@ -1681,9 +1599,9 @@ namespace header_tool
 		//Q_ASSERT( !def->normalizedType.empty() );
 		if ( def->arguments.empty() && def->normalizedType == "void" && !def->isPrivateSignal )
 		{
-			fprintf( out, ")%s\n{\n"
-				"    QMetaObject::activate(%s, &staticMetaObject, %d, nullptr);\n"
-				"}\n", constQualifier, thisPtr.data(), index );
+			out << ")" << constQualifier << "\n{\n"
+				"    QMetaObject::activate(" << thisPtr << ", &staticMetaObject, " << index << ", nullptr);\n"
+				"}\n";
 			return;
 		}
 
@@ -1692,116 +1610,205 @@ namespace header_tool
 		{
 			const ArgumentDef &a = def->arguments.at( j );
 			if ( j )
-				fprintf( out, ", " );
-			fprintf( out, "%s _t%d%s", a.type.name.data(), offset++, a.rightType.data() );
+				out << ", ";
+			out << a.type.name << " _t" << offset++ << a.rightType;
 		}
 		if ( def->isPrivateSignal )
 		{
 			if ( !def->arguments.empty() )
-				fprintf( out, ", " );
-			fprintf( out, "QPrivateSignal _t%d", offset++ );
+				out << ", ";
+			out << "QPrivateSignal _t" << offset++;
 		}
 
-		fprintf( out, ")%s\n{\n", constQualifier );
+		out << ")" << constQualifier << "\n{\n";
 		if ( def->type.name.size() && def->normalizedType != "void" )
 		{
 			std::string returnType = noRef( def->normalizedType );
-			fprintf( out, "    %s _t0{};\n", returnType.data() );
+			out << "    " << returnType << " _t0{};\n";
 		}
 
-		fprintf( out, "    void *_a[] = { " );
+		out << "    void *_a[] = { ";
 		if ( def->normalizedType == "void" )
 		{
-			fprintf( out, "nullptr" );
+			out << "nullptr";
 		}
 		else
 		{
 			if ( def->returnTypeIsVolatile )
-				fprintf( out, "const_cast<void*>(reinterpret_cast<const volatile void*>(&_t0))" );
+				out << "const_cast<void*>(reinterpret_cast<const volatile void*>(&_t0))";
 			else
-				fprintf( out, "const_cast<void*>(reinterpret_cast<const void*>(&_t0))" );
+				out << "const_cast<void*>(reinterpret_cast<const void*>(&_t0))";
 		}
 		int i;
 		for ( i = 1; i < offset; ++i )
 			if ( i <= def->arguments.size() && def->arguments.at( i - 1 ).type.isVolatile )
-				fprintf( out, ", const_cast<void*>(reinterpret_cast<const volatile void*>(&_t%d))", i );
+				out << ", const_cast<void*>(reinterpret_cast<const volatile void*>(&_t" << i << "))";
 			else
-				fprintf( out, ", const_cast<void*>(reinterpret_cast<const void*>(&_t%d))", i );
-		fprintf( out, " };\n" );
-		fprintf( out, "    QMetaObject::activate(%s, &staticMetaObject, %d, _a);\n", thisPtr.data(), index );
+				out << ", const_cast<void*>(reinterpret_cast<const void*>(&_t" << i << "))";
+		out << " };\n";
+		out << "    QMetaObject::activate(" << thisPtr << ", &staticMetaObject, " << index << ", _a);\n";
 		if ( def->normalizedType != "void" )
-			fprintf( out, "    return _t0;\n" );
-		fprintf( out, "}\n" );
+			out << "    return _t0;\n";
+		out << "}\n";
 	}
-	/*
-	static void writePluginMetaData( FILE *out, const QJsonObject &data )
+	// rapidjson output stream that prints the bytes it receives as the body of a string literal.
+	// One literal is far cheaper for the C++ compiler than an initializer with a token per byte.
+	class PluginMetaDataStream
 	{
-		const QJsonDocument doc( data );
+	public:
+		typedef char Ch;
 
-		fputs( "\nQT_PLUGIN_METADATA_SECTION\n"
-			"static const unsigned char qt_pluginMetaData[] = {\n"
-			"    'Q', 'T', 'M', 'E', 'T', 'A', 'D', 'A', 'T', 'A', ' ', ' ',\n   ", out );
-#if 0
-		fprintf( out, "\"%s\";\n", doc.toJson().data() );
-#else
-		const std::string binary = doc.toBinaryData();
-		const int last = binary.size() - 1;
-		for ( int i = 0; i < last; ++i )
+		explicit PluginMetaDataStream( code_buffer &out )
+			: out( out )
+		{
+		}
+
+		void Put( char c )
+		{
+			if ( column >= 72 )
+			{
+				out << "\"\n    \"";
+				column = 0;
+			}
+			const uint8 u = uint8( c );
+			if ( c == '"' || c == '\\' )
+			{
+				out << '\\' << c;
+				column += 2;
+			}
+			else if ( u < 0x20 || u >= 0x7f || c == '?' ) // '?' could start a trigraph
+			{
+				// always three digits, so a following digit is never taken into the escape
+				out << '\\' << char( '0' + (u >> 6) ) << char( '0' + ((u >> 3) & 7) ) << char( '0' + (u & 7) );
+				column += 4;
+			}
+			else
+			{
+				out << c;
+				++column;
+			}
+		}
+
+		void Flush()
 		{
-			uchar c = (uchar)binary.at( i );
-			if ( c < 0x20 || c >= 0x7f )
-				fprintf( out, " 0x%02x,", c );
-			else if ( c == '\'' || c == '\\' )
-				fprintf( out, " '\\%c',", c );
+		}
+
+	private:
+		code_buffer &out;
+		int column = 0;
+	};
+
+	// Feeds the plugin meta data object to any rapidjson SAX handler.
+	template<typename Handler>
+	static void writePluginMetaDataObject( Handler &writer, const ClassDef *cdef, bool debug )
+	{
+		writer.StartObject();
+
+		// QJsonObject kept its keys sorted and -M arguments replaced built in keys of the same
+		// name, so merge both sorted sequences the same way.
+		const auto &metaArgs = cdef->pluginData.metaArgs;
+		auto arg = metaArgs.begin();
+		auto writeMetaArgsUntil = [&]( const char *key ) {
+			for ( ; arg != metaArgs.end() && (!key || arg->first <= key); ++arg )
+			{
+				writer.Key( arg->first.data(), rapidjson::SizeType( arg->first.size() ) );
+				writer.StartArray();
+				for ( const std::string &value : arg->second )
+					writer.String( value.data(), rapidjson::SizeType( value.size() ) );
+				writer.EndArray( rapidjson::SizeType( arg->second.size() ) );
+			}
+			return !key || metaArgs.count( key ) == 0;
+		};
+
+		if ( writeMetaArgsUntil( "IID" ) )
+		{
+			writer.Key( "IID" );
+			writer.String( cdef->pluginData.iid.data(), rapidjson::SizeType( cdef->pluginData.iid.size() ) );
+		}
+		if ( writeMetaArgsUntil( "MetaData" ) )
+		{
+			writer.Key( "MetaData" );
+			const std::string &metaData = cdef->pluginData.metaData;
+			if ( metaData.empty() )
+			{
+				writer.StartObject();
+				writer.EndObject( 0 );
+			}
 			else
-				fprintf( out, " '%c', ", c );
-			if ( !((i + 1) % 8) )
-				fputs( "\n   ", out );
+			{
+				// already validated and minified by the parser
+				rapidjson::StringStream stream( metaData.c_str() );
+				rapidjson::Reader().Parse( stream, writer );
+			}
 		}
-		fprintf( out, " 0x%02x\n};\n", (uchar)binary.at( last ) );
-#endif
+		if ( writeMetaArgsUntil( "className" ) )
+		{
+			writer.Key( "className" );
+			writer.String( cdef->classname.data(), rapidjson::SizeType( cdef->classname.size() ) );
+		}
+		if ( writeMetaArgsUntil( "debug" ) )
+		{
+			writer.Key( "debug" );
+			writer.Bool( debug );
+		}
+		if ( writeMetaArgsUntil( "version" ) )
+		{
+			writer.Key( "version" );
+			writer.Int( 0x010000 /* QT_VERSION */ );
+		}
+		writeMetaArgsUntil( nullptr );
+
+		writer.EndObject( 0 );
+	}
+
+	static void writePluginMetaData( code_buffer &out, const ClassDef *cdef, bool debug )
+	{
+		// The CBOR payload uses string keys and lacks the version header of Qt's own binary
+		// layout, so it gets a marker of its own that QPluginLoader never scans for.
+		// Note that sizeof(qt_pluginMetaData) includes the literal's terminating zero.
+		const bool json = cdef->pluginData.format == ClassDef::PluginData::Json;
+		out << "\nQT_PLUGIN_METADATA_SECTION\n"
+			"static const unsigned char qt_pluginMetaData[] =\n"
+			"    \"" << (json ? "QTMETADATA  " : "MOCMETACBOR!") << "\"\n"
+			"    \"";
+
+		PluginMetaDataStream stream( out );
+		if ( json )
+		{
+			rapidjson::Writer<PluginMetaDataStream> writer( stream );
+			writePluginMetaDataObject( writer, cdef, debug );
+		}
+		else
+		{
+			cbor_writer<PluginMetaDataStream> writer( stream );
+			writePluginMetaDataObject( writer, cdef, debug );
+		}
+
+		out << "\";\n";
 	}
-	*/
 
 	void Generator::generatePluginMetaData()
 	{
-		/*
 		if ( cdef->pluginData.iid.empty() )
 			return;
 
 		// Write plugin meta data #ifdefed QT_NO_DEBUG with debug=false,
 		// true, respectively.
 
-		QJsonObject data;
-		const std::string debugKey = std::stringLiteral( "debug" );
-		data.insert( std::stringLiteral( "IID" ), QLatin1String( cdef->pluginData.iid.data() ) );
-		data.insert( std::stringLiteral( "className" ), QLatin1String( cdef->classname.data() ) );
-		data.insert( std::stringLiteral( "version" ), (int)QT_VERSION );
-		data.insert( debugKey, QJsonValue( false ) );
-		data.insert( std::stringLiteral( "MetaData" ), cdef->pluginData.metaData.object() );
-
-		// Add -M args from the command line:
-		for ( auto it = cdef->pluginData.metaArgs.cbegin(), end = cdef->pluginData.metaArgs.cend(); it != end; ++it )
-			data.insert( it.key(), it.value() );
+		out << "\nQT_PLUGIN_METADATA_SECTION const uint32 qt_section_alignment_dummy = 42;\n\n"
+			"#ifdef QT_NO_DEBUG\n";
+		writePluginMetaData( out, cdef, false );
 
-		fputs( "\nQT_PLUGIN_METADATA_SECTION const uint32 qt_section_alignment_dummy = 42;\n\n"
-			"#ifdef QT_NO_DEBUG\n", out );
-		writePluginMetaData( out, data );
+		out << "\n#else // QT_NO_DEBUG\n";
 
-		fputs( "\n#else // QT_NO_DEBUG\n", out );
+		writePluginMetaData( out, cdef, true );
 
-		data.remove( debugKey );
-		data.insert( debugKey, QJsonValue( true ) );
-		writePluginMetaData( out, data );
-
-		fputs( "#endif // QT_NO_DEBUG\n\n", out );
+		out << "#endif // QT_NO_DEBUG\n\n";
 
 		// 'Use' all namespaces.
-		int pos = cdef->qualified.indexOf( "::" );
-		for ( ; pos != -1; pos = cdef->qualified.indexOf( "::", pos + 2 ) )
-			fprintf( out, "using namespace %s;\n", cdef->qualified.left( pos ).data() );
-		fprintf( out, "QT_MOC_EXPORT_PLUGIN(%s, %s)\n\n",
-			cdef->qualified.data(), cdef->classname.data() );
-		*/
+		size_t pos = cdef->qualified.find( "::" );
+		for ( ; pos != std::string::npos; pos = cdef->qualified.find( "::", pos + 2 ) )
+			out << "using namespace " << std::string_view( cdef->qualified.data(), pos ) << ";\n";
+		out << "QT_MOC_EXPORT_PLUGIN(" << cdef->qualified << ", " << cdef->classname << ")\n\n";
 	}
 }
@@ -2,16 +2,21 @@
 #define GENERATOR_H
 
 #include "moc.h"
+#include "moc_code_buffer.h"
+#include "moc_type_classifier.h"
 
 namespace header_tool {
 
+bool isBuiltinType(const std::string &type);
+
 class Generator
 {
-    FILE *out;
+    code_buffer &out;
     ClassDef *cdef;
+    type_classifier &types;
     std::vector<uint32> meta_data;
 public:
-    Generator(ClassDef *classDef, const std::vector<std::string> &metaTypes, const std::unordered_map<std::string, std::string> &knownQObjectClasses, const std::unordered_map<std::string, std::string> &knownGadgets, FILE *outfile = 0);
+    Generator(ClassDef *classDef, type_classifier &types, const std::unordered_map<std::string, std::string> &knownQObjectClasses, const std::unordered_map<std::string, std::string> &knownGadgets, code_buffer &outfile);
     void generateCode();
 private:
     bool registerableMetaType(const std::string &propertyType);
@@ -35,11 +40,11 @@ private:
 
     void strreg(const std::string &); // registers a string
     int stridx(const std::string &); // returns a string's id
-    std::vector<std::string> strings;
+    std::vector<std::string> strings; // in registration order, as emitted
+    std::unordered_map<std::string, int> stringIndex; // position of each string in strings
     std::string purestSuperClass;
-    std::vector<std::string> metaTypes;
-    std::unordered_map<std::string, std::string> knownQObjectClasses;
-    std::unordered_map<std::string, std::string> knownGadgets;
+    const std::unordered_map<std::string, std::string> &knownQObjectClasses;
+    const std::unordered_map<std::string, std::string> &knownGadgets;
 };
 
 }
@@ -3,6 +3,10 @@
 //#include "qdatetime.h"
 #include "utils.h"
 #include "outputrevision.h"
+
+#include <rapidjson/reader.h>
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
 //#include <QtCore/qfile.h>
 //#include <QtCore/qfileinfo.h>
 //#include <QtCore/qdir.h>
@@ -12,7 +16,9 @@
 namespace header_tool
 {
 	// This function is shared with moc.cpp. This file should be included where needed.
-	static std::string normalizeTypeInternal(const char *t, const char *e, bool fixScope = false, bool adjustConst = true)
+	// Appends the normalized form of [t, e) to result, so template arguments are written in
+	// place instead of being built as temporaries and concatenated.
+	static void normalizeTypeInternal(const char *t, const char *e, std::string &result, bool fixScope = false, bool adjustConst = true)
 	{
 		size_t len = e - t;
 		/*
@@ -51,8 +57,8 @@ namespace header_tool
 				t += 6;
 			}
 		}
-		std::string result;
-		result.reserve(len);
+		const size_t start = result.size();
+		result.reserve(start + len);
 
 #if 1
 		// consume initial 'const '
@@ -110,10 +116,10 @@ namespace header_tool
 			if (fixScope && c == ':' && *t == ':' ) {
 				++t;
 				c = *t++;
-				size_t i = result.size() - 1;
-				while (i >= 0 && is_ident_char(result.at(i)))
+				size_t i = result.size();
+				while (i > start && is_ident_char(result[i - 1]))
 					--i;
-				result.resize(i + 1);
+				result.resize(i);
 			}
 			star = star || c == '*';
 			result += c;
@@ -134,7 +140,7 @@ namespace header_tool
 						if (c == '>')
 							--templdepth;
 						if (templdepth == 0 || (templdepth == 1 && c == ',')) {
-							result += normalizeTypeInternal(tt, t-1, fixScope, false);
+							normalizeTypeInternal(tt, t-1, result, fixScope, false);
 							result += c;
 							if (templdepth == 0) {
 								if (*t == '>')
@@ -160,19 +166,17 @@ namespace header_tool
 					// treat const as value
 				} else if (!star) {
 					// move const to the front (but not if const comes after a *)
-					result.insert(0, "const ");
+					result.insert(start, "const ");
 				} else {
 					// keep const after a *
 					result += "const";
 				}
 			}
 		}
-
-		return result;
 	}
 
 	// only moc needs this function
-	static std::string normalizeType(const std::string &ba, bool fixScope = false)
+	static void normalizeType(const std::string &ba, std::string &result, bool fixScope = false)
 	{
 		const char *s = ba.data();
 		size_t len = ba.size();
@@ -195,10 +199,21 @@ namespace header_tool
 			}
 		}
 		*d = '\0';
-		std::string result = normalizeTypeInternal(buf, d, fixScope);
+		result.clear();
+		normalizeTypeInternal(buf, d, result, fixScope);
 		if (buf != stackbuf)
 			delete[] buf;
-		return result;
+	}
+
+	const std::string &Moc::normalizedType(const std::string &spelling)
+	{
+		auto it = normalizedTypes.find(spelling);
+		if (it == normalizedTypes.end())
+		{
+			it = normalizedTypes.emplace(spelling, std::string()).first;
+			normalizeType(spelling, it->second);
+		}
+		return it->second;
 	}
 
 	bool Moc::parseClassHead(ClassDef *def)
@@ -470,20 +485,24 @@ namespace header_tool
 				break;
 			if (test(IDENTIFIER))
 				arg.name = lexem();
+			std::string rightType;
 			while (test(LBRACK))
 			{
-				arg.rightType += lexemUntil(RBRACK);
+				rightType += lexemUntil(RBRACK);
 			}
 			if (test(CONST) || test(VOLATILE))
 			{
-				arg.rightType += ' ';
-				arg.rightType += lexem();
-			}
-			arg.normalizedType = normalizeType(std::string(arg.type.name + ' ' + arg.rightType));
-			arg.typeNameForCast = normalizeType(std::string(noRef(arg.type.name) + "(*)" + arg.rightType));
+				rightType += ' ';
+				rightType += lexem();
+			}
+			arg.rightType = rightType;
+			typeSpelling.assign(arg.type.name).append(1, ' ').append(rightType);
+			arg.normalizedType = normalizedType(typeSpelling);
+			typeSpelling.assign(noRef(arg.type.name)).append("(*)").append(rightType);
+			arg.typeNameForCast = normalizedType(typeSpelling);
 			if (test(EQ))
 				arg.isDefault = true;
-			def->arguments.push_back(arg);
+			def->arguments.push_back(std::move(arg));
 			if (!until(COMMA))
 				break;
 		}
@@ -590,9 +609,7 @@ namespace header_tool
 					error();
 				else
 				{
-					if (!def->tag.empty())
-						def->tag += ' ';
-					def->tag += def->type.name;
+					def->tag = def->tag.empty() ? def->type.name : def->tag + ' ' + def->type.name;
 				}
 				def->type = tempType;
 				tempType = parseType();
@@ -610,7 +627,7 @@ namespace header_tool
 			def->type.rawName = rawName;
 		}
 
-		def->normalizedType = normalizeType(def->type.name);
+		def->normalizedType = normalizedType(def->type.name);
 
 		if (!test(RPAREN))
 		{
@@ -703,9 +720,7 @@ namespace header_tool
 					def->isSlot = true;
 				else
 				{
-					if (!def->tag.empty())
-						def->tag += ' ';
-					def->tag += def->type.name;
+					def->tag = def->tag.empty() ? def->type.name : def->tag + ' ' + def->type.name;
 				}
 				def->type = tempType;
 				tempType = parseType();
@@ -724,7 +739,7 @@ namespace header_tool
 			def->type.rawName = rawName;
 		}
 
-		def->normalizedType = normalizeType(def->type.name);
+		def->normalizedType = normalizedType(def->type.name);
 
 		if (!test(RPAREN))
 		{
@@ -744,10 +759,27 @@ namespace header_tool
 		return true;
 	}
 
+	// Appends def to list, followed by one clone per trailing default argument with that
+	// argument dropped. Only the clones are copies; def itself is moved in last.
+	static void appendWithClones(std::vector<FunctionDef> &list, FunctionDef &&def)
+	{
+		while (def.arguments.size() > 0 && def.arguments.back().isDefault)
+		{
+			list.push_back(def);
+			def.wasCloned = true;
+			def.arguments.pop_back();
+		}
+		list.push_back(std::move(def));
+	}
+
 	void Moc::parse()
 	{
+		PROFILE_SCOPE_DETAIL("Moc::parse", filename);
+		ALLOC_SCOPE("Moc::parse");
 		std::vector<NamespaceDef> namespaceList;
 		bool templateClass = false;
+		if (fastScan)
+			buildBraceMatches();
 		while (hasNext())
 		{
 			Token t = next();
@@ -790,7 +822,7 @@ namespace header_tool
 								const bool parseNamespace = currentFilenames.size() <= 1;
 								if (parseNamespace)
 								{
-									for (size_t i = namespaceList.size() - 1; i >= 0; --i)
+									for (int i = int(namespaceList.size()) - 1; i >= 0; --i)
 									{
 										if (inNamespace(&namespaceList.at(i)))
 										{
@@ -805,7 +837,7 @@ namespace header_tool
 										def.qualified += ns + "::";
 										parentNs.begin = def.begin;
 										parentNs.end = def.end;
-										namespaceList.push_back(parentNs);
+										namespaceList.push_back(std::move(parentNs));
 									}
 								}
 
@@ -856,7 +888,7 @@ namespace header_tool
 											{
 												EnumDef enumDef;
 												if (parseEnum(&enumDef))
-													def.enumList.push_back(enumDef);
+													def.enumList.push_back(std::move(enumDef));
 											} break;
 										case CLASS:
 										case STRUCT:
@@ -867,6 +899,10 @@ namespace header_tool
 												while (inClass(&classdef) && hasNext())
 													next(); // consume all Q_XXXX std::unordered_map<std::string, Macro> from this class
 											} break;
+										case LBRACE:
+											if (lookup(-1) == RPAREN || lookup(-1) == CONST)
+												skipBraces();
+											break;
 										default: break;
 									}
 								}
@@ -882,6 +918,11 @@ namespace header_tool
 				case RBRACE:
 					templateClass = false;
 					break;
+				case LBRACE:
+					// the body of a function, which cannot declare anything moc looks for
+					if ((lookup(-1) == RPAREN || lookup(-1) == CONST) && skipBraces())
+						templateClass = false;
+					break;
 				case TEMPLATE:
 					templateClass = true;
 					break;
@@ -932,7 +973,7 @@ namespace header_tool
 						if (!def.hasQObject && !def.hasQGadget)
 							continue;
 
-						for (size_t i = namespaceList.size() - 1; i >= 0; --i)
+						for (int i = int(namespaceList.size()) - 1; i >= 0; --i)
 							if (inNamespace(&namespaceList.at(i)))
 							{
 
@@ -953,7 +994,7 @@ namespace header_tool
 			if (parseClassHead(&def))
 			{
 				FunctionDef::Access access = FunctionDef::Private;
-				for (size_t i = namespaceList.size() - 1; i >= 0; --i)
+				for (int i = int(namespaceList.size()) - 1; i >= 0; --i)
 					if (inNamespace(&namespaceList.at(i)))
 						def.qualified.insert(0, namespaceList.at(i).classname + "::");
 				while (inClass(&def) && hasNext())
@@ -1054,29 +1095,27 @@ namespace header_tool
 							{
 								EnumDef enumDef;
 								if (parseEnum(&enumDef))
-									def.enumList.push_back(enumDef);
+									def.enumList.push_back(std::move(enumDef));
 							} break;
 						case SEMIC:
 						case COLON:
 							break;
+						case LBRACE:
+							// an inline function body or a brace initializer
+							skipBraces();
+							break;
 						default:
 							FunctionDef funcDef;
 							funcDef.access = access;
 							int rewind = index--;
+							if (fastScan && access != FunctionDef::Public && skipMemberDeclaration())
+								break;
 							if (parseMaybeFunction(&def, &funcDef))
 							{
 								if (funcDef.isConstructor)
 								{
 									if ((access == FunctionDef::Public) && funcDef.isInvokable)
-									{
-										def.constructorList.push_back(funcDef);
-										while (funcDef.arguments.size() > 0 && funcDef.arguments.back().isDefault)
-										{
-											funcDef.wasCloned = true;
-											funcDef.arguments.pop_back();
-											def.constructorList.push_back(funcDef);
-										}
-									}
+										appendWithClones(def.constructorList, std::move(funcDef));
 								}
 								else if (funcDef.isDestructor)
 								{
@@ -1084,44 +1123,26 @@ namespace header_tool
 								}
 								else
 								{
-									if (access == FunctionDef::Public)
-										def.publicList.push_back(funcDef);
+									std::vector<FunctionDef> *list = nullptr;
 									if (funcDef.isSlot)
-									{
-										def.slotList.push_back(funcDef);
-										while (funcDef.arguments.size() > 0 && funcDef.arguments.back().isDefault)
-										{
-											funcDef.wasCloned = true;
-											funcDef.arguments.pop_back();
-											def.slotList.push_back(funcDef);
-										}
-										if (funcDef.revision > 0)
-											++def.revisionedMethods;
-									}
+										list = &def.slotList;
 									else if (funcDef.isSignal)
-									{
-										def.signalList.push_back(funcDef);
-										while (funcDef.arguments.size() > 0 && funcDef.arguments.back().isDefault)
-										{
-											funcDef.wasCloned = true;
-											funcDef.arguments.pop_back();
-											def.signalList.push_back(funcDef);
-										}
-										if (funcDef.revision > 0)
-											++def.revisionedMethods;
-									}
+										list = &def.signalList;
 									else if (funcDef.isInvokable)
+										list = &def.methodList;
+									if (list && funcDef.revision > 0)
+										++def.revisionedMethods;
+
+									// the public list only needs its own copy if a meta list takes the original
+									if (access == FunctionDef::Public)
 									{
-										def.methodList.push_back(funcDef);
-										while (funcDef.arguments.size() > 0 && funcDef.arguments.back().isDefault)
-										{
-											funcDef.wasCloned = true;
-											funcDef.arguments.pop_back();
-											def.methodList.push_back(funcDef);
-										}
-										if (funcDef.revision > 0)
-											++def.revisionedMethods;
+										if (list)
+											def.publicList.push_back(funcDef);
+										else
+											def.publicList.push_back(std::move(funcDef));
 									}
+									if (list)
+										appendWithClones(*list, std::move(funcDef));
 								}
 							}
 							else
@@ -1141,20 +1162,20 @@ namespace header_tool
 				if (!def.hasQObject && !def.hasQGadget)
 					error("Class declaration lacks Q_OBJECT macro.");
 
-				// TODO
-				/*
 				// Add meta tags to the plugin meta data:
 				if (!def.pluginData.iid.empty())
+				{
 					def.pluginData.metaArgs = metaArgs;
-				*/
+					def.pluginData.format = pluginMetaDataFormat;
+				}
 
 				checkSuperClasses(&def);
 				checkProperties(&def);
 
-				classList.push_back(def);
 				std::unordered_map<std::string, std::string> &classHash = def.hasQObject ? knownQObjectClasses : knownGadgets;
 				classHash.insert_or_assign(def.classname, def.qualified);
 				classHash.insert_or_assign(def.qualified, def.qualified);
+				classList.push_back(std::move(def));
 			}
 		}
 		for (const auto &n : namespaceList)
@@ -1180,91 +1201,87 @@ namespace header_tool
 			{
 				knownGadgets.insert_or_assign(def.classname, def.qualified);
 				knownGadgets.insert_or_assign(def.qualified, def.qualified);
-				classList.push_back(def);
+				classList.push_back(std::move(def));
 			}
 		}
 	}
 
-	static bool any_type_contains(const std::vector<PropertyDef> &properties, const std::string &pattern)
+	static std::vector<std::string> make_candidates()
 	{
-		for (const auto &p : properties)
-		{
-			if (p.type.find(pattern) != std::string::npos)
-				return true;
-		}
-		return false;
+		std::vector<std::string> result;
+		for (const char *smartPointer : automaticSmartPointers)
+			result.push_back(smartPointer);
+		for (const char *oneArgTemplate : automaticOneArgTemplates)
+			result.push_back(oneArgTemplate);
+		return result;
 	}
 
-	static bool any_arg_contains(const std::vector<FunctionDef> &functions, const std::string &pattern)
+	// Marks every candidate that appears as a template name in type. A candidate matches when
+	// it ends right before a '<', like a substring search for candidate + '<' would find it.
+	static void find_candidates(const std::string &type, const std::unordered_map<std::string_view, size_t> &index, std::vector<bool> &found)
 	{
-		for (const auto &f : functions)
+		for (size_t open = type.find('<'); open != std::string::npos; open = type.find('<', open + 1))
 		{
-			for (const auto &arg : f.arguments)
+			size_t begin = open;
+			while (begin > 0 && is_ident_char(type[begin - 1]))
+				--begin;
+			for (; begin < open; ++begin)
 			{
-				if (arg.normalizedType.find(pattern) != std::string::npos)
-					return true;
+				auto it = index.find(std::string_view(type.data() + begin, open - begin));
+				if (it != index.end())
+					found[it->second] = true;
 			}
 		}
-		return false;
-	}
-
-	static std::vector<std::string> make_candidates()
-	{
-		std::vector<std::string> result;
-		// todo
-		/*
-		result
-#define STREAM_SMART_POINTER(SMART_POINTER) << #SMART_POINTER
-			QT_FOR_EACH_AUTOMATIC_TEMPLATE_SMART_POINTER(STREAM_SMART_POINTER)
-#undef STREAM_SMART_POINTER
-#define STREAM_1ARG_TEMPLATE(TEMPLATENAME) << #TEMPLATENAME
-			QT_FOR_EACH_AUTOMATIC_TEMPLATE_1ARG(STREAM_1ARG_TEMPLATE)
-#undef STREAM_1ARG_TEMPLATE
-			;
-			*/
-		return result;
 	}
 
 	static std::vector<std::string> requiredQtContainers(const std::vector<ClassDef> &classes)
 	{
-		static const std::vector<std::string> candidates = make_candidates();
-
-		std::vector<std::string> required;
-		required.reserve(candidates.size());
-
-		for (const auto &candidate : candidates)
-		{
-			const std::string pattern = candidate + '<';
-
-			for (const auto &c : classes)
+		// leaked on purpose, other files may still be generated while static objects are torn down
+		static const std::vector<std::string> &candidates = *new std::vector<std::string>(make_candidates());
+		static const std::unordered_map<std::string_view, size_t> &index = *[] {
+			auto *result = new std::unordered_map<std::string_view, size_t>();
+			for (size_t i = 0; i < candidates.size(); ++i)
+				result->emplace(candidates[i], i);
+			return result;
+		}();
+
+		// one pass over every type string, instead of one per candidate
+		std::vector<bool> found(candidates.size());
+		for (const auto &c : classes)
+		{
+			for (const auto &p : c.propertyList)
+				find_candidates(p.type, index, found);
+			for (const auto *functions : { &c.slotList, &c.signalList, &c.methodList })
 			{
-				if (any_type_contains(c.propertyList, pattern) ||
-					any_arg_contains(c.slotList, pattern) ||
-					any_arg_contains(c.signalList, pattern) ||
-					any_arg_contains(c.methodList, pattern))
+				for (const auto &f : *functions)
 				{
-					required.push_back(candidate);
-					break;
+					for (const auto &arg : f.arguments)
+						find_candidates(arg.normalizedType, index, found);
 				}
 			}
 		}
 
+		std::vector<std::string> required;
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{
+			if (found[i])
+				required.push_back(candidates[i]);
+		}
 		return required;
 	}
 
-	void Moc::generate(FILE *out)
+	void Moc::generate(std::string &output)
 	{
-		std::string fn = filename;
-		size_t i = filename.length() - 1;
-		while (i > 0 && filename.at(i - 1) != '/' && filename.at(i - 1) != '\\')
-			--i;                                // skip path
-		if (i >= 0)
-			fn = sub(filename, i);
-		fprintf(out, "/****************************************************************************\n"
-			"** Meta object code from reading C++ file '%s'\n**\n", fn.data());
-		fprintf(out, "** Created by: The Qt Meta Object Compiler version %d (Qt %s)\n**\n", mocOutputRevision, "1.0" /* QT_VERSION_STR */);
-		fprintf(out, "** WARNING! All changes made in this file will be lost!\n"
-			"*****************************************************************************/\n\n");
+		code_buffer out;
+
+		// skip path
+		const size_t lastSeparator = filename.find_last_of("/\\");
+		const std::string fn = lastSeparator == std::string::npos ? filename : filename.substr(lastSeparator + 1);
+		out << "/****************************************************************************\n"
+			"** Meta object code from reading C++ file '" << fn << "'\n**\n";
+		out << "** Created by: The Qt Meta Object Compiler version " << mocOutputRevision << " (Qt " << "1.0" /* QT_VERSION_STR */ << ")\n**\n";
+		out << "** WARNING! All changes made in this file will be lost!\n"
+			"*****************************************************************************/\n\n";
 
 
 		if (!noInclude)
@@ -1280,45 +1297,53 @@ namespace header_tool
 						inc.insert(0, includePath);
 					inc = '\"' + inc + '\"';
 				}
-				fprintf(out, "#include %s\n", inc.data());
+				out << "#include " << inc << "\n";
 			}
 		}
 		if (classList.size() && classList.front().classname == "Qt")
-			fprintf(out, "#include <QtCore/qobject.h>\n");
+			out << "#include <QtCore/qobject.h>\n";
 
-		fprintf(out, "#include <QtCore/std::string.h>\n"); // For std::stringData
-		fprintf(out, "#include <QtCore/qmetatype.h>\n");  // For QMetaType::Type
+		out << "#include <QtCore/std::string.h>\n"; // For std::stringData
+		out << "#include <QtCore/qmetatype.h>\n";  // For QMetaType::Type
 		if (mustIncludeQPluginH)
-			fprintf(out, "#include <QtCore/qplugin.h>\n");
+			out << "#include <QtCore/qplugin.h>\n";
 
 		const auto qtContainers = requiredQtContainers(classList);
 		for (const std::string &qtContainer : qtContainers)
-			fprintf(out, "#include <QtCore/%s>\n", qtContainer.data());
+			out << "#include <QtCore/" << qtContainer << ">\n";
 
 
-		fprintf(out, "#if !defined(Q_MOC_OUTPUT_REVISION)\n"
-			"#error \"The header file '%s' doesn't include <QObject>.\"\n", fn.data());
-		fprintf(out, "#elif Q_MOC_OUTPUT_REVISION != %d\n", mocOutputRevision);
-		fprintf(out, "#error \"This file was generated using the moc from %s."
+		out << "#if !defined(Q_MOC_OUTPUT_REVISION)\n"
+			"#error \"The header file '" << fn << "' doesn't include <QObject>.\"\n";
+		out << "#elif Q_MOC_OUTPUT_REVISION != " << mocOutputRevision << "\n";
+		out << "#error \"This file was generated using the moc from " << "1.0" /* QT_VERSION_STR */ << "."
 			" It\"\n#error \"cannot be used with the include files from"
 			" this version of Qt.\"\n#error \"(The moc has changed too"
-			" much.)\"\n", "1.0" /* QT_VERSION_STR */ );
-		fprintf(out, "#endif\n\n");
+			" much.)\"\n";
+		out << "#endif\n\n";
 
-		fprintf(out, "QT_BEGIN_MOC_NAMESPACE\n");
-		fprintf(out, "QT_WARNING_PUSH\n");
-		fprintf(out, "QT_WARNING_DISABLE_DEPRECATED\n");
+		out << "QT_BEGIN_MOC_NAMESPACE\n";
+		out << "QT_WARNING_PUSH\n";
+		out << "QT_WARNING_DISABLE_DEPRECATED\n";
 
-		fputs("", out);
-		for (i = 0; i < classList.size(); ++i)
+		type_classifier types(metaTypes, knownQObjectClasses);
+		for (size_t i = 0; i < classList.size(); ++i)
 		{
-			Generator generator(&classList[i], metaTypes, knownQObjectClasses, knownGadgets, out);
+			Generator generator(&classList[i], types, knownQObjectClasses, knownGadgets, out);
 			generator.generateCode();
 		}
-		fputs("", out);
 
-		fprintf(out, "QT_WARNING_POP\n");
-		fprintf(out, "QT_END_MOC_NAMESPACE\n");
+		out << "QT_WARNING_POP\n";
+		out << "QT_END_MOC_NAMESPACE\n";
+
+		output = out.take();
+	}
+
+	void Moc::generate(FILE *out)
+	{
+		std::string output;
+		generate(output);
+		fwrite(output.data(), 1, output.size(), out);
 	}
 
 	void Moc::parseSlots(ClassDef *def, FunctionDef::Access access)
@@ -1375,13 +1400,7 @@ namespace header_tool
 				funcDef.revision = defaultRevision;
 				++def->revisionedMethods;
 			}
-			def->slotList.push_back(funcDef);
-			while (funcDef.arguments.size() > 0 && funcDef.arguments.back().isDefault)
-			{
-				funcDef.wasCloned = true;
-				funcDef.arguments.pop_back();
-				def->slotList.push_back(funcDef);
-			}
+			appendWithClones(def->slotList, std::move(funcDef));
 		}
 	}
 
@@ -1441,13 +1460,7 @@ namespace header_tool
 				funcDef.revision = defaultRevision;
 				++def->revisionedMethods;
 			}
-			def->signalList.push_back(funcDef);
-			while (funcDef.arguments.size() > 0 && funcDef.arguments.back().isDefault)
-			{
-				funcDef.wasCloned = true;
-				funcDef.arguments.pop_back();
-				def->signalList.push_back(funcDef);
-			}
+			appendWithClones(def->signalList, std::move(funcDef));
 		}
 	}
 
@@ -1466,7 +1479,7 @@ namespace header_tool
 		  QValueList<QVariant>, the other template class supported by
 		  QVariant.
 		*/
-		type = normalizeType(type);
+		type = normalizedType(type);
 		if (type == "std::map")
 			type = "std::map<std::string,QVariant>";
 		else if (type == "QValueList")
@@ -1600,7 +1613,30 @@ namespace header_tool
 			def->notifyableProperties++;
 		if (propDef.revision > 0)
 			++def->revisionedProperties;
-		def->propertyList.push_back(propDef);
+		def->propertyList.push_back(std::move(propDef));
+	}
+
+	std::string Moc::pluginMetaDataPath(const std::string &currentFile, const std::string &metaDataFile) const
+	{
+		// QFileInfo fi(QFileInfo(currentFile).dir(), metaDataFile);
+		std::filesystem::path fi = std::filesystem::path(currentFile).parent_path();
+		fi /= metaDataFile;
+		for (size_t j = 0; j < includes.size() && !std::filesystem::exists(fi); ++j)
+		{
+			const IncludePath &p = includes.at(j);
+			if (p.isFrameworkPath)
+				continue;
+
+			fi = p.path;
+			fi /= metaDataFile;
+			// try again, maybe there's a file later in the include paths with the same name
+			if (std::filesystem::is_directory(fi))
+			{
+				fi.clear();
+				continue;
+			}
+		}
+		return std::filesystem::exists(fi) ? fi.string() : std::string();
 	}
 
 	void Moc::parsePluginData(ClassDef *def)
@@ -1619,35 +1655,15 @@ namespace header_tool
 			{
 				next(STRING_LITERAL);
 				std::string metaDataFile = unquotedLexem();
-				std::filesystem::path fi = currentFilenames.top();
-				fi /= metaDataFile;
-
-				FILE* f = fopen(fi.string().c_str(), "r");
-				// QFileInfo fi(QFileInfo(std::string::fromLocal8Bit(currentFilenames.top().constData())).dir(), std::string::fromLocal8Bit(metaDataFile.constData()));
-				for (int j = 0; j < includes.size() && !std::filesystem::exists(fi); ++j)
-				{
-					const IncludePath &p = includes.at(j);
-					if (p.isFrameworkPath)
-						continue;
-
-					fi = p.path;
-					fi /= metaDataFile;
-					//fi.setFile(std::string::fromLocal8Bit(p.path.data()), std::string::fromLocal8Bit(metaDataFile.data()));
-					// try again, maybe there's a file later in the include paths with the same name
-					if (std::filesystem::is_directory(fi))
-					{
-						fi.clear();// = QFileInfo();
-						continue;
-					}
-				}
-				if (!std::filesystem::exists(fi))
+				const std::string path = pluginMetaDataPath(currentFilenames.top(), metaDataFile);
+				if (path.empty())
 				{
 					const std::string msg = "Plugin Metadata file " + lexem()
 						+ " does not exist. Declaration will be ignored";
 					error(msg.data());
 					return;
 				}
-				FILE* file = fopen(fi.string().c_str(), "r");
+				FILE* file = fopen(path.c_str(), "r");
 				//QFile file(fi.canonicalFilePath());
 				if (!file) // file.open(QFile::ReadOnly))
 				{
@@ -1661,9 +1677,15 @@ namespace header_tool
 
 		if (!metaData.empty())
 		{
-			/*
-			def->pluginData.metaData = QJsonDocument::fromJson(metaData);
-			if (!def->pluginData.metaData.isObject())
+			// Parse in place and keep only the minified text, the generator splices it into the
+			// plugin meta data verbatim.
+			rapidjson::StringBuffer minified;
+			rapidjson::Writer<rapidjson::StringBuffer> writer(minified);
+			rapidjson::Reader reader;
+			rapidjson::InsituStringStream stream(&metaData[0]);
+			const size_t first = metaData.find_first_not_of(" \t\r\n");
+			if (first == std::string::npos || metaData[first] != '{'
+				|| !reader.Parse<rapidjson::kParseInsituFlag>(stream, writer))
 			{
 				const std::string msg = "Plugin Metadata file " + lexem()
 					+ " does not contain a valid JSON object. Declaration will be ignored";
@@ -1671,7 +1693,7 @@ namespace header_tool
 				def->pluginData.iid = std::string();
 				return;
 			}
-			*/
+			def->pluginData.metaData.assign(minified.GetString(), minified.GetSize());
 		}
 
 		mustIncludeQPluginH = true;
@@ -1683,19 +1705,20 @@ namespace header_tool
 		next(LPAREN);
 		PropertyDef propDef;
 		next(IDENTIFIER);
-		propDef.inPrivateClass = lexem();
+		std::string inPrivateClass = lexem();
 		while (test(SCOPE))
 		{
-			propDef.inPrivateClass += lexem();
+			inPrivateClass += lexem();
 			next(IDENTIFIER);
-			propDef.inPrivateClass += lexem();
+			inPrivateClass += lexem();
 		}
 		// also allow void functions
 		if (test(LPAREN))
 		{
 			next(RPAREN);
-			propDef.inPrivateClass += "()";
+			inPrivateClass += "()";
 		}
+		propDef.inPrivateClass = inPrivateClass;
 
 		next(COMMA);
 
@@ -1706,7 +1729,7 @@ namespace header_tool
 		if (propDef.revision > 0)
 			++def->revisionedProperties;
 
-		def->propertyList.push_back(propDef);
+		def->propertyList.push_back(std::move(propDef));
 	}
 
 	void Moc::parseEnumOrFlag(BaseDef *def, bool isFlag)
@@ -1775,7 +1798,7 @@ namespace header_tool
 			next(RPAREN);
 		}
 		next(RPAREN);
-		def->classInfoList.push_back(infoDef);
+		def->classInfoList.push_back(std::move(infoDef));
 	}
 
 	void Moc::parseInterfaces(ClassDef *def)
@@ -1811,7 +1834,7 @@ namespace header_tool
 
 				iface[i].interfaceId = iid;
 			}
-			def->interfaceList.push_back(iface);
+			def->interfaceList.push_back(std::move(iface));
 		}
 		next(RPAREN);
 	}
@@ -1849,7 +1872,7 @@ namespace header_tool
 		std::string typeName = lexemUntil(RPAREN);
 		typeName.erase(0, 1);
 		typeName.erase(typeName.back(), 1);
-		metaTypes.push_back(typeName);
+		metaTypes.push_back(std::move(typeName));
 	}
 
 	void Moc::parseSlotInPrivate(ClassDef *def, FunctionDef::Access access)
@@ -1857,25 +1880,20 @@ namespace header_tool
 		next(LPAREN);
 		FunctionDef funcDef;
 		next(IDENTIFIER);
-		funcDef.inPrivateClass = lexem();
+		std::string inPrivateClass = lexem();
 		// also allow void functions
 		if (test(LPAREN))
 		{
 			next(RPAREN);
-			funcDef.inPrivateClass += "()";
+			inPrivateClass += "()";
 		}
+		funcDef.inPrivateClass = inPrivateClass;
 		next(COMMA);
 		funcDef.access = access;
 		parseFunction(&funcDef, true);
-		def->slotList.push_back(funcDef);
-		while (funcDef.arguments.size() > 0 && funcDef.arguments.back().isDefault)
-		{
-			funcDef.wasCloned = true;
-			funcDef.arguments.pop_back();
-			def->slotList.push_back(funcDef);
-		}
 		if (funcDef.revision > 0)
 			++def->revisionedMethods;
+		appendWithClones(def->slotList, std::move(funcDef));
 
 	}
 
@@ -1903,6 +1921,10 @@ namespace header_tool
 
 	bool Moc::until(Token target)
 	{
+		// a brace block is balanced in between, so the counting below would stop at its match
+		if (target == RBRACE && index && symbols.at(index - 1).token == LBRACE && skipBraces())
+			return true;
+
 		int braceCount = 0;
 		int brackCount = 0;
 		int parenCount = 0;
@@ -1992,6 +2014,147 @@ namespace header_tool
 		return false;
 	}
 
+	// Pairs every LBRACE with its RBRACE in one pass over the symbols, so a body can be
+	// skipped in constant time. Braces whose contents are not properly nested, or that span
+	// an included file, keep -1 and are walked token by token as before.
+	void Moc::buildBraceMatches()
+	{
+		braceMatch.assign(symbols.size(), -1);
+		std::vector<int> open;
+		for (int i = 0; i < int(symbols.size()); ++i)
+		{
+			Token opening = NOTOKEN;
+			switch (symbols[i].token)
+			{
+				case LBRACE:
+				case LPAREN:
+				case LBRACK:
+					open.push_back(i);
+					continue;
+				case RBRACE: opening = LBRACE; break;
+				case RPAREN: opening = LPAREN; break;
+				case RBRACK: opening = LBRACK; break;
+				case MOC_INCLUDE_BEGIN:
+				case MOC_INCLUDE_END:
+					open.clear();
+					continue;
+				default:
+					continue;
+			}
+			if (open.empty() || symbols[open.back()].token != opening)
+			{
+				open.clear();
+				continue;
+			}
+			if (opening == LBRACE)
+				braceMatch[open.back()] = i;
+			open.pop_back();
+		}
+	}
+
+	// With fastScan, moves past the RBRACE matching the LBRACE just read.
+	bool Moc::skipBraces()
+	{
+		if (!fastScan || index <= 0 || index > int(braceMatch.size()) || braceMatch[index - 1] < 0)
+			return false;
+		index = braceMatch[index - 1] + 1;
+		return true;
+	}
+
+	// Whether a member declaration can go on with token after a parenthesized group at its top
+	// level, like the qualifiers, initializer or body after a parameter list do.
+	static bool continuesDeclaration(Token token)
+	{
+		switch (token)
+		{
+			case SEMIC:
+			case LBRACE:
+			case LPAREN:
+			case LBRACK:
+			case EQ:
+			case COLON:
+			case COMMA:
+			case ARROW:
+			case AND:
+			case ANDAND:
+			case CONST:
+			case VOLATILE:
+			case THROW:
+			case IDENTIFIER:	// override, final, noexcept and macros standing for them
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	// Skips a class member declaration starting at the current symbol, as long as it holds no
+	// moc macro (Q_INVOKABLE, Q_SLOT, Q_REVISION, ...). Such a member outside the public section
+	// never makes it into the meta object, so there is no point in parsing its type and
+	// arguments. Returns false and leaves the position alone if the member must be parsed.
+	// Anything that may start a declaration of its own, which a macro without a semicolon such as
+	// Q_DISABLE_COPY(Foo) would otherwise let the skip swallow, is left to the full parse too.
+	bool Moc::skipMemberDeclaration()
+	{
+		const int start = index;
+		int depth = 0;
+		while (index < int(symbols.size()))
+		{
+			const Token t = symbols.at(index++).token;
+			if (t >= Q_META_TOKEN_BEGIN && t < Q_META_TOKEN_END)
+				break;
+
+			bool done = false;
+			bool fail = false;
+			switch (t)
+			{
+				case LPAREN:
+				case LBRACK:
+					++depth;
+					break;
+				case RPAREN:
+				case RBRACK:
+					fail = --depth < 0 || (depth == 0 && t == RPAREN && !continuesDeclaration(lookup()));
+					break;
+				case SEMIC:
+					done = depth == 0;
+					break;
+				case ENUM:
+				case CLASS:
+				case STRUCT:
+				case UNION:
+				case SIGNALS:
+				case SLOTS:
+					fail = true;
+					break;
+				case LBRACE:
+					if (!skipBraces())
+						fail = true;
+					else if (depth == 0)
+					{
+						// a function body ends the member, a brace initializer or a lambda goes on
+						done = test(SEMIC) || (lookup() != LPAREN && lookup() != COMMA);
+					}
+					break;
+				case RBRACE:
+				case PUBLIC:
+				case PROTECTED:
+				case PRIVATE:
+				case MOC_INCLUDE_BEGIN:
+				case MOC_INCLUDE_END:
+					fail = true;
+					break;
+				default:
+					break;
+			}
+			if (done)
+				return true;
+			if (fail)
+				break;
+		}
+		index = start;
+		return false;
+	}
+
 	void Moc::checkSuperClasses(ClassDef *def)
 	{
 		const std::string firstSuperclass = std::get<0>(def->superclassList[0]);
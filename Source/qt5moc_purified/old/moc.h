@@ -2,6 +2,7 @@
 #define MOC_H
 
 #include "parser.h"
+#include "moc_interned_string.h"
 //#include <std::vector<std::string>.h>
 #include <map>
 #include <tuple>
@@ -63,8 +64,8 @@ namespace header_tool
 
 	struct EnumDef
 	{
-		std::string name;
-		std::vector<std::string> values;
+		interned_string name;
+		std::vector<interned_string> values;
 		bool isEnumClass; // c++11 enum class
 		EnumDef() : isEnumClass(false)
 		{}
@@ -76,8 +77,8 @@ namespace header_tool
 		ArgumentDef() : isDefault(false)
 		{}
 		Type type;
-		std::string rightType, normalizedType, name;
-		std::string typeNameForCast; // type name to be used in cast from void * in metacall
+		interned_string rightType, normalizedType, name;
+		interned_string typeNameForCast; // type name to be used in cast from void * in metacall
 		bool isDefault;
 	};
 	//Q_DECLARE_TYPEINFO(ArgumentDef, Q_MOVABLE_TYPE);
@@ -90,9 +91,9 @@ namespace header_tool
 			isConstructor(false), isDestructor(false), isAbstract(false), revision(0)
 		{}
 		Type type;
-		std::string normalizedType;
-		std::string tag;
-		std::string name;
+		interned_string normalizedType;
+		interned_string tag;
+		interned_string name;
 		bool returnTypeIsVolatile;
 
 		std::vector<ArgumentDef> arguments;
@@ -108,7 +109,7 @@ namespace header_tool
 		bool inlineCode;
 		bool wasCloned;
 
-		std::string inPrivateClass;
+		interned_string inPrivateClass;
 		bool isCompat;
 		bool isInvokable;
 		bool isScriptable;
@@ -127,7 +128,7 @@ namespace header_tool
 	{
 		PropertyDef() :notifyId(-1), constant(false), final(false), gspec(ValueSpec), revision(0)
 		{}
-		std::string name, type, member, read, write, reset, designable, scriptable, editable, stored, user, notify, inPrivateClass;
+		interned_string name, type, member, read, write, reset, designable, scriptable, editable, stored, user, notify, inPrivateClass;
 		int notifyId;
 		bool constant;
 		bool final;
@@ -150,8 +151,8 @@ namespace header_tool
 
 	struct ClassInfoDef
 	{
-		std::string name;
-		std::string value;
+		interned_string name;
+		interned_string value;
 	};
 	//Q_DECLARE_TYPEINFO(ClassInfoDef, Q_MOVABLE_TYPE);
 
@@ -189,9 +190,9 @@ namespace header_tool
 		struct PluginData
 		{
 			std::string iid;
-			// TODO:
-			//std::map<std::string, QJsonArray> metaArgs;
-			//QJsonDocument metaData;
+			std::map<std::string, std::vector<std::string> > metaArgs;
+			std::string metaData; // minified JSON object, empty if no FILE was given
+			enum Format { Cbor, Json } format = Json; // encoding of the emitted qt_pluginMetaData
 		} pluginData;
 
 		std::vector<FunctionDef> constructorList;
@@ -211,6 +212,14 @@ namespace header_tool
 	};
 	//Q_DECLARE_TYPEINFO(NamespaceDef, Q_MOVABLE_TYPE);
 
+	// QT_FOR_EACH_AUTOMATIC_TEMPLATE_SMART_POINTER
+	// smart pointers to QObject subclasses are registered automatically
+	constexpr const char *automaticSmartPointers[] = { "QSharedPointer", "QWeakPointer", "QPointer" };
+
+	// QT_FOR_EACH_AUTOMATIC_TEMPLATE_1ARG
+	// containers of builtin or registerable types are registered automatically
+	constexpr const char *automaticOneArgTemplates[] = { "QList", "QVector", "QQueue", "QStack", "QSet", "QLinkedList" };
+
 	class Moc : public Parser
 	{
 	public:
@@ -230,11 +239,20 @@ namespace header_tool
 		// map from class name to fully qualified name
 		std::unordered_map<std::string, std::string> knownQObjectClasses;
 		std::unordered_map<std::string, std::string> knownGadgets;
-		// TODO:
-		// std::map<std::string, QJsonArray> metaArgs;
+		std::map<std::string, std::vector<std::string> > metaArgs;
+		ClassDef::PluginData::Format pluginMetaDataFormat = ClassDef::PluginData::Json;
+		// normalized form of every type spelling seen so far, the same types recur in most signatures
+		std::unordered_map<std::string, std::string> normalizedTypes;
+		// scratch for composing argument type spellings without reallocating
+		std::string typeSpelling;
+		// jump over function bodies and members that cannot contribute meta object data
+		bool fastScan = false;
+		// position of the matching RBRACE for every LBRACE, -1 where unknown; only built with fastScan
+		std::vector<int> braceMatch;
 
 		void parse();
 		void generate(FILE *out);
+		void generate(std::string &output);
 
 		bool parseClassHead(ClassDef *def);
 		inline bool inClass(const ClassDef *def) const
@@ -248,6 +266,7 @@ namespace header_tool
 		}
 
 		Type parseType();
+		const std::string &normalizedType(const std::string &spelling);
 
 		bool parseEnum(EnumDef *def);
 
@@ -258,6 +277,9 @@ namespace header_tool
 		void parseSignals(ClassDef *def);
 		void parseProperty(ClassDef *def);
 		void parsePluginData(ClassDef *def);
+		// file named by Q_PLUGIN_METADATA(FILE ...) in currentFile: next to it, else on the
+		// include paths; empty if it does not exist
+		std::string pluginMetaDataPath(const std::string &currentFile, const std::string &metaDataFile) const;
 		void createPropertyDef(PropertyDef &def);
 		void parseEnumOrFlag(BaseDef *def, bool isFlag);
 		void parseFlag(BaseDef *def);
@@ -273,6 +295,10 @@ namespace header_tool
 		std::string lexemUntil(Token);
 		bool until(Token);
 
+		void buildBraceMatches();
+		bool skipBraces();
+		bool skipMemberDeclaration();
+
 		// test for Q_INVOCABLE, Q_SCRIPTABLE, etc. and set the flags
 		// in FunctionDef accordingly
 		bool testFunctionAttribute(FunctionDef *def);
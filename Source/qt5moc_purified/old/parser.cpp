@@ -28,7 +28,7 @@ void Parser::error(const char *msg) {
     else
         fprintf(stderr, ErrorFormatString "Parse error at \"%s\"\n",
                  currentFilenames.top().c_str(), symbol().lineNum, symbol().lexem().data());
-    exit(EXIT_FAILURE);
+    throw parse_error();
 }
 
 void Parser::warning(const char *msg) {
@@ -9,6 +9,12 @@
 
 namespace header_tool
 {
+	// Thrown by Parser::error once the message is printed. The driver catches it per input
+	// file, so a bad header fails on its own instead of exiting the process.
+	struct parse_error
+	{
+	};
+
 	class Parser
 	{
 	public:
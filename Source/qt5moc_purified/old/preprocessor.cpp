@@ -31,6 +31,8 @@ namespace header_tool
 // backslash-newlines into newlines
 	static std::string cleaned(const std::string &input)
 	{
+		PROFILE_SCOPE("cleaned");
+		ALLOC_SCOPE("cleaned");
 		std::string result;
 		result.resize(input.size());
 		const char *data = input.data();
@@ -150,6 +152,8 @@ namespace header_tool
 
 	std::vector<Symbol> Preprocessor::tokenize(const std::string& input, int lineNum, Preprocessor::TokenizeMode mode)
 	{
+		PROFILE_SCOPE("tokenize");
+		ALLOC_SCOPE("tokenize");
 		std::vector<Symbol> symbols;
 		// Preallocate some space to speed up the code below.
 		// The magic divisor value was found by calculating the average ratio between
@@ -619,12 +623,15 @@ namespace header_tool
 			return std::vector<Symbol>();
 		}
 
+		PROFILE_SCOPE("macroExpand");
+		ALLOC_SCOPE("macroExpand");
 		const Macro &macro = (*macro_itr).second;
 		*macroName = s.lexem();
 
 		std::vector<Symbol> expansion;
 		if (!macro.isFunction)
 		{
+			++that->stats.macro_expansions;
 			expansion = macro.symbols;
 		}
 		else
@@ -644,6 +651,8 @@ namespace header_tool
 				syms.back().lineNum = lineNum;
 				return syms;
 			}
+			// only counted here, a function-like macro name without arguments is not expanded
+			++that->stats.macro_expansions;
 			std::vector<std::vector<Symbol>> arguments;
 			arguments.reserve(5);
 			while (symbols.hasNext())
@@ -1063,6 +1072,7 @@ namespace header_tool
 
 	int Preprocessor::evaluateCondition()
 	{
+		++stats.conditionals;
 		PP_Expression expression;
 		expression.currentFilenames = currentFilenames;
 
@@ -1073,6 +1083,8 @@ namespace header_tool
 
 	static std::string readOrMapFile(FILE* file)
 	{
+		PROFILE_SCOPE("readOrMapFile");
+		ALLOC_SCOPE("readOrMapFile");
 		std::ifstream ifs(file);
 		std::string content;
 		if (file)
@@ -1191,6 +1203,8 @@ namespace header_tool
 
 	void Preprocessor::preprocess(const std::string &filename, std::vector<Symbol> &preprocessed)
 	{
+		PROFILE_SCOPE_DETAIL("preprocess", filename);
+		ALLOC_SCOPE("preprocess");
 		currentFilenames.push(filename);
 		preprocessed.reserve(preprocessed.size() + symbols.size());
 		while (hasNext())
@@ -1219,9 +1233,13 @@ namespace header_tool
 							continue;
 
 						if (Preprocessor::preprocessedIncludes.find(include) != Preprocessor::preprocessedIncludes.end())
+						{
+							++stats.includes_skipped;
 							continue;
+						}
 
 						Preprocessor::preprocessedIncludes.insert(include);
+						PROFILE_SCOPE_DETAIL("include", include);
 
 						FILE* file = fopen(include.c_str(), "r");
 						if (!file)
@@ -1229,7 +1247,10 @@ namespace header_tool
 							continue;
 						}
 
+						++stats.includes_opened;
 						std::string input = readOrMapFile(file);
+						stats.bytes_read += input.size();
+						stats.lines += std::count(input.begin(), input.end(), '\n');
 
 						fclose(file);
 						if (input.empty())
@@ -1243,6 +1264,7 @@ namespace header_tool
 
 						// phase 2: tokenize for the preprocessor
 						symbols = tokenize(input);
+						stats.tokens += symbols.size();
 						input.clear();
 
 						index = 0;
@@ -1314,6 +1336,7 @@ namespace header_tool
 							}
 						}
 						macros.insert_or_assign(name, macro);
+						++stats.macro_definitions;
 						continue;
 					}
 				case PP_UNDEF:
@@ -1381,6 +1404,8 @@ namespace header_tool
 	std::vector<Symbol> Preprocessor::preprocessed(const std::string &filename, FILE*& file)
 	{
 		std::string input = readOrMapFile(file);
+		stats.bytes_read += input.size();
+		stats.lines += std::count(input.begin(), input.end(), '\n');
 
 		if (input.empty())
 			return symbols;
@@ -1391,6 +1416,7 @@ namespace header_tool
 		// phase 2: tokenize for the preprocessor
 		index = 0;
 		symbols = tokenize(input);
+		stats.tokens += symbols.size();
 
 #if 0
 		for (int j = 0; j < symbols.size(); ++j)
@@ -2,6 +2,7 @@
 #define PREPROCESSOR_H
 
 #include "parser.h"
+#include "moc_stats.h"
 #include <list>
 #include <set>
 #include <string>
@@ -43,6 +44,7 @@ namespace header_tool
 		std::unordered_map<std::string, std::string> nonlocalIncludePathResolutionCache;
 		//std::unordered_map<std::string, std::string> nonlocalIncludePathResolutionCache;
 		std::unordered_map<std::string, Macro> macros;
+		file_stats stats;
 		std::string resolveInclude(const std::string &filename, const std::string &relativeTo);
 		std::vector<Symbol> preprocessed(const std::string &filename, FILE*& device);
 
@@ -142,7 +142,8 @@ namespace header_tool
 			pos = 0;
 		}
 
-		if (len + pos > vec.size())
+		// len - pos rather than len + pos, which wraps for the default len of an unsigned U
+		if (len > vec.size() - pos)
 		{
 			len = vec.size() - pos;
 		}
@@ -1,6 +1,11 @@
 #include "preprocessor.h"
 #include "moc.h"
 #include "outputrevision.h"
+#include "moc_cache.h"
+#include "moc_output.h"
+#include "moc_reflection_json.h"
+#include "moc_reflection_db.h"
+#include "moc_class_index.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -166,13 +171,236 @@ namespace header_tool
 		return allArguments;
 	}
 
+	// Settings shared by every input file of a run.
+	struct RunOptions
+	{
+		bool autoInclude = true;
+		bool defaultInclude = true;
+		bool writeIfChanged = false;
+		bool needsClassModel = false; // parse even if the code comes from the cache
+		std::vector<std::string> includeFiles; // --include
+		std::string cacheDirectory;
+		std::vector<std::string> cacheOptions; // option values that are part of the cache key
+	};
+
+	// Runs one header through preprocessing, parsing and generation. pp and moc are copies
+	// configured from the command line; moc keeps the parsed classes and pp.stats the
+	// file's statistics for the caller.
+	static int runPipeline(Preprocessor &pp, Moc &moc, const RunOptions &options, std::string filename,
+		const std::string &output, const std::string &jsonOutput)
+	{
+		PROFILE_SCOPE_DETAIL("processFile", filename);
+		pp.stats.filename = filename;
+		FILE* in = 0;
+		FILE* out = 0;
+
+		if (options.autoInclude)
+		{
+			const size_t spos = filename.rfind('/');
+			const size_t ppos = filename.rfind('.');
+			moc.noInclude = (ppos != std::string::npos && (spos == std::string::npos || ppos > spos)
+				&& std::tolower(filename[ppos + 1]) != 'h');
+		}
+		if (options.defaultInclude)
+		{
+			if (moc.includePath.empty())
+			{
+				if (filename.size())
+				{
+					if (output.size())
+					{
+						//moc.includeFiles.push_back(combinePath(filename, output));
+					}
+					else
+					{
+						moc.includeFiles.push_back(filename);
+					}
+				}
+			}
+			else
+			{
+				//moc.includeFiles.push_back(combinePath(filename, filename));
+			}
+		}
+		if (filename.empty())
+		{
+			filename = "standard input";
+			//in.open(stdin, QIODevice::ReadOnly);
+		}
+		else
+		{
+			in = fopen(filename.c_str(), "r");
+			if (!in)
+			{
+				fprintf(stderr, "moc: %s: No such file\n", filename.c_str());
+				return 1;
+			}
+			moc.filename = filename;
+		}
+
+		moc.currentFilenames.push(filename);
+		moc.includes = pp.includes;
+
+		// 1. preprocess
+		phase_timer preprocessTimer(pp.stats.preprocess);
+		for (const std::string &includeName : options.includeFiles)
+		{
+			std::string rawName = pp.resolveInclude(includeName, moc.filename);
+			if (rawName.empty())
+			{
+				fprintf(stderr, "Warning: Failed to resolve include \"%s\" for moc file %s\n",
+					includeName.data(),
+					moc.filename.empty() ? "<standard input>" : moc.filename.data());
+			}
+			else
+			{
+				FILE* f = fopen(rawName.c_str(), "w");
+				if (f)
+				{
+					moc.symbols.emplace_back(0, MOC_INCLUDE_BEGIN, rawName);
+					auto temp = pp.preprocessed(rawName, f);
+					moc.symbols.insert(moc.symbols.end(), std::make_move_iterator(temp.begin()), std::make_move_iterator(temp.end()));
+					moc.symbols.emplace_back(0, MOC_INCLUDE_END, rawName);
+				}
+				else
+				{
+					fprintf(stderr, "Warning: Cannot open %s included by moc file %s: %s\n",
+						rawName.data(),
+						moc.filename.empty() ? "<standard input>" : moc.filename.data(), "error"
+						/*f.errorString().toLocal8Bit().constData()*/);
+				}
+			}
+		}
+
+		auto temp = pp.preprocessed(moc.filename, in);
+		if (moc.symbols.empty())
+			moc.symbols = std::move(temp);
+		else
+			moc.symbols.insert(moc.symbols.end(), std::make_move_iterator(temp.begin()), std::make_move_iterator(temp.end()));
+		preprocessTimer.stop();
+		pp.stats.symbols = moc.symbols.size();
+
+		// A cache hit skips parsing and generation entirely.
+		const std::string &cacheDirectory = options.cacheDirectory;
+		const bool useCache = !pp.preprocessOnly && !cacheDirectory.empty();
+		std::string cacheKey;
+		std::string generated;
+		bool cacheHit = false;
+		if (useCache)
+		{
+			cacheKey = result_cache::key(moc, options.cacheOptions);
+			cacheHit = result_cache(cacheDirectory).lookup(cacheKey, generated);
+			pp.stats.cache_hits = cacheHit ? 1 : 0;
+		}
+
+		// the reflection data needs the class model even when the code comes from the cache
+		if (!pp.preprocessOnly && (!cacheHit || options.needsClassModel))
+		{
+			// 2. parse
+			phase_timer timer(pp.stats.parse);
+			moc.parse();
+			pp.stats.count_classes(moc);
+		}
+
+		if (jsonOutput.size() && !pp.preprocessOnly)
+		{
+			std::string json;
+			write_reflection_json(moc, json);
+			if (!write_if_changed(jsonOutput, json))
+			{
+				fprintf(stderr, "moc: Cannot create %s\n", jsonOutput.c_str());
+				return 1;
+			}
+		}
+
+		// 3. and output meta object code
+
+		// Generating into memory lets an identical output file keep its timestamp, which would
+		// otherwise trigger recompiles of everything including it.
+		const bool inMemory = useCache || (!pp.preprocessOnly && options.writeIfChanged && output.size());
+		phase_timer generateTimer(pp.stats.generate);
+		if (!pp.preprocessOnly && !cacheHit)
+		{
+			if (moc.classList.empty())
+				moc.note("No relevant classes found. No output generated.");
+			else if (inMemory)
+				moc.generate(generated);
+
+			if (useCache)
+				result_cache(cacheDirectory).store(cacheKey, generated);
+		}
+
+		pp.stats.bytes_emitted = generated.size();
+		if (inMemory && output.size())
+		{
+			if (!write_if_changed(output, generated))
+			{
+				fprintf(stderr, "moc: Cannot create %s\n", output.c_str());
+				return 1;
+			}
+			return 0;
+		}
+
+		if (output.size())
+		{ // output file specified
+#if defined(_MSC_VER) && _MSC_VER >= 1400
+			if (fopen_s(&out, output.c_str(), "w"))
+#else
+			out = fopen(output).constData(), "w"); // create output file
+			if (!out)
+#endif
+			{
+				fprintf(stderr, "moc: Cannot create %s\n", output.c_str());
+				return 1;
+			}
+		}
+		else
+		{ // use stdout
+			out = stdout;
+		}
+
+		if (pp.preprocessOnly)
+			fprintf(out, "%s\n", composePreprocessorOutput(moc.symbols).data());
+		else if (inMemory)
+			fwrite(generated.data(), 1, generated.size(), out);
+		else if (!moc.classList.empty())
+		{
+			const long start = ftell(out);
+			moc.generate(out);
+			const long end = ftell(out);
+			if (start >= 0 && end >= start)
+				pp.stats.bytes_emitted = uint64_t(end - start);
+		}
+
+		if (output.size())
+			fclose(out);
+
+		return 0;
+	}
+
+	// A parse error has already been printed when it unwinds to here. It fails only this file,
+	// so the other headers of a batch keep going on their worker threads.
+	static int processFile(Preprocessor &pp, Moc &moc, const RunOptions &options, const std::string &filename,
+		const std::string &output, const std::string &jsonOutput)
+	{
+		try
+		{
+			return runPipeline(pp, moc, options, filename, output, jsonOutput);
+		}
+		catch (const parse_error &)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
 	int runMoc(int argc, char **argv)
 	{
 		// QCoreApplication app(argc, argv);
 		// QCoreApplication::setApplicationVersion(std::string::fromLatin1(QT_VERSION_STR));
 
-		bool autoInclude = true;
-		bool defaultInclude = true;
+		const double runWallStart = PlatformTime::Seconds();
+		const double runCpuStart = PlatformTime::ProcessCpuSeconds();
+		RunOptions options;
 		Preprocessor pp;
 		Moc moc;
 		pp.macros["Q_MOC_RUN"];
@@ -188,8 +416,6 @@ namespace header_tool
 
 		std::string filename;
 		std::string output;
-		FILE* in = 0;
-		FILE* out = 0;
 
 #pragma region cmdline
 		// Note that moc isn't translated.
@@ -290,7 +516,70 @@ namespace header_tool
 		ignoreConflictsOption.setDescription("Ignore all options that conflict with compilers, like -pthread conflicting with moc's -p option.");
 		clp.addOption(ignoreConflictsOption);
 
-		clp.addPositionalArgument("[header-file]", "Header file to read from, otherwise stdin.");
+		CommandLineOption pluginMetaDataFormatOption("plugin-metadata-format");
+		pluginMetaDataFormatOption.setDescription("Set the encoding of embedded plugin meta data: either \"json\" (default, read by QPluginLoader) or \"cbor\" (compact, behind a MOCMETACBOR! marker that Qt does not load).");
+		pluginMetaDataFormatOption.setValueName("format");
+		clp.addOption(pluginMetaDataFormatOption);
+
+		CommandLineOption writeIfChangedOption("write-if-changed");
+		writeIfChangedOption.setDescription("Only replace the output file if the generated code differs from it.");
+		clp.addOption(writeIfChangedOption);
+
+		CommandLineOption outputJsonOption("output-json");
+		outputJsonOption.setDescription("Also write the parsed class model as JSON to file.");
+		outputJsonOption.setValueName("file");
+		clp.addOption(outputJsonOption);
+
+		CommandLineOption cacheDirOption("cache-dir");
+		cacheDirOption.setDescription("Reuse generated code for unchanged headers, keyed on the preprocessed tokens. Stored in dir.");
+		cacheDirOption.setValueName("dir");
+		clp.addOption(cacheDirOption);
+
+		CommandLineOption reflectionDbOption("reflection-db");
+		reflectionDbOption.setDescription("Write the classes of all input files to file as one memory mappable reflection database.");
+		reflectionDbOption.setValueName("file");
+		clp.addOption(reflectionDbOption);
+
+		CommandLineOption fastScanOption("fast-scan");
+		fastScanOption.setDescription("Skip function bodies and members without moc macros instead of parsing them.");
+		clp.addOption(fastScanOption);
+
+		CommandLineOption classIndexOption("class-index");
+		classIndexOption.setDescription("Treat the QObjects and gadgets listed in the class index file as known, even if they are not included.");
+		classIndexOption.setValueName("file");
+		clp.addOption(classIndexOption);
+
+		CommandLineOption writeClassIndexOption("write-class-index");
+		writeClassIndexOption.setDescription("Write the QObjects and gadgets declared in all input files to a class index file.");
+		writeClassIndexOption.setValueName("file");
+		clp.addOption(writeClassIndexOption);
+
+		CommandLineOption jobsOption("jobs");
+		jobsOption.setDescription("Process several header files on up to n threads. 0 (default) uses every hardware thread.");
+		jobsOption.setValueName("n");
+		clp.addOption(jobsOption);
+
+		CommandLineOption lockStatsOption("lock-stats");
+		lockStatsOption.setDescription("Write lock contention statistics as JSON to file on exit and on SIGUSR1. Needs a build with CORE_LOCK_STATS=1.");
+		lockStatsOption.setValueName("file");
+		clp.addOption(lockStatsOption);
+
+		CommandLineOption traceOption("trace");
+		traceOption.setDescription("Write a Chrome trace (chrome://tracing, Perfetto) of where the time goes to file on exit.");
+		traceOption.setValueName("file");
+		clp.addOption(traceOption);
+
+		CommandLineOption allocStatsOption("alloc-stats");
+		allocStatsOption.setDescription("Write allocation counters, the peak of live heap bytes and the top allocating scopes as JSON to file on exit. Needs a build with CORE_ALLOC_TRACKING=1.");
+		allocStatsOption.setValueName("file");
+		clp.addOption(allocStatsOption);
+
+		CommandLineOption statsOption("stats");
+		statsOption.setDescription("Write counters and per phase wall and CPU times for every input and the whole run as JSON to file. Class counters of --cache-dir hits are 0 unless another output needs the parse.");
+		statsOption.setValueName("file");
+		clp.addOption(statsOption);
+
+		clp.addPositionalArgument("[header-file]", "Header file to read from, otherwise stdin. With several header files -o and --output-json name directories that receive moc_<header>.cpp and moc_<header>.json.");
 		clp.addPositionalArgument("[@option-file]", "Read additional options from option-file.");
 #pragma endregion cmdline
 
@@ -303,23 +592,25 @@ namespace header_tool
 			return 1;
 
 		clp.process(arguments);
-		const std::vector<std::string> files = clp.positionalArguments();
-		if (files.size() > 1)
+		if (clp.isSet(lockStatsOption))
+			LockStats::DumpOnExit(clp.value(lockStatsOption).c_str());
+		if (clp.isSet(allocStatsOption))
+			AllocationTracker::DumpOnExit(clp.value(allocStatsOption).c_str());
+		if (clp.isSet(traceOption))
 		{
-			std::cout << (std::string("Too many input files specified: '") + join(files, "' '") + '\'');
-			clp.showHelp(1);
+			Profiler::DumpOnExit(clp.value(traceOption).c_str());
+			Profiler::SetThreadName("main");
 		}
-		else if (!files.empty())
-		{
+		const std::vector<std::string> files = clp.positionalArguments();
+		if (files.size() == 1)
 			filename = files.front();
-		}
 		const bool ignoreConflictingOptions = clp.isSet(ignoreConflictsOption);
 		output = clp.value(outputOption);
 		pp.preprocessOnly = clp.isSet(preprocessOption);
 		if (clp.isSet(noIncludeOption))
 		{
 			moc.noInclude = true;
-			autoInclude = false;
+			options.autoInclude = false;
 		}
 
 		if (!ignoreConflictingOptions)
@@ -327,12 +618,12 @@ namespace header_tool
 			if (clp.isSet(forceIncludeOption))
 			{
 				moc.noInclude = false;
-				autoInclude = false;
+				options.autoInclude = false;
 				const auto forceIncludes = clp.values(forceIncludeOption);
 				for (const std::string &include : forceIncludes)
 				{
 					moc.includeFiles.push_back(include);
-					defaultInclude = false;
+					options.defaultInclude = false;
 				}
 			}
 			const auto prependIncludes = clp.values(prependIncludeOption);
@@ -375,6 +666,15 @@ namespace header_tool
 			clp.showHelp(1);
 		}
 
+		const std::string pluginMetaDataFormat = clp.value(pluginMetaDataFormatOption);
+		if (pluginMetaDataFormat == "cbor")
+			moc.pluginMetaDataFormat = ClassDef::PluginData::Cbor;
+		else if (!pluginMetaDataFormat.empty() && pluginMetaDataFormat != "json")
+		{
+			printf((std::string("Unknown plugin meta data format '") + pluginMetaDataFormat + "'; valid values are: cbor, json.").c_str());
+			clp.showHelp(1);
+		}
+
 		const auto macFrameworks = clp.values(macFrameworkOption);
 		for (const std::string &path : macFrameworks)
 		{
@@ -422,50 +722,6 @@ namespace header_tool
 		if (clp.isSet(noWarningsOption) || std::find(noNotesCompatValues.begin(), noNotesCompatValues.end(),"w") != noNotesCompatValues.end())
 		moc.displayWarnings = moc.displayNotes = false;
 
-		if (autoInclude)
-		{
-			int spos = std::distance(filename.begin(), std::find(filename.end(), filename.begin(), '/'));
-			int ppos = std::distance(filename.begin(), std::find(filename.end(), filename.begin(), '.'));
-			// spos >= -1 && ppos > spos => ppos >= 0
-			moc.noInclude = (ppos > spos && std::tolower(filename[ppos + 1]) != 'h');
-		}
-		if (defaultInclude)
-		{
-			if (moc.includePath.empty())
-			{
-				if (filename.size())
-				{
-					if (output.size())
-					{
-						//moc.includeFiles.push_back(combinePath(filename, output));
-					}
-					else
-					{
-						moc.includeFiles.push_back(filename);
-					}
-				}
-			}
-			else
-			{
-				//moc.includeFiles.push_back(combinePath(filename, filename));
-			}
-		}
-		if (filename.empty())
-		{
-			filename = "standard input";
-			//in.open(stdin, QIODevice::ReadOnly);
-		}
-		else
-		{
-			in = fopen(filename.c_str(), "r");
-			if (!in)
-			{
-				fprintf(stderr, "moc: %s: No such file\n", filename.c_str());
-				return 1;
-			}
-			moc.filename = filename;
-		}
-
 		const auto metadata = clp.values(metadataOption);
 		for (const std::string &md : metadata)
 		{
@@ -485,89 +741,138 @@ namespace header_tool
 			}
 			else
 			{
-				//QJsonArray array = moc.metaArgs.value(key);
-				//array.append(value);
-				//moc.metaArgs.insert(key, array);
+				moc.metaArgs[key].push_back(value);
 			}
 		}
 
-		moc.currentFilenames.push(filename);
-		moc.includes = pp.includes;
-
-		// 1. preprocess
-		const auto includeFiles = clp.values(includeOption);
-		for (const std::string &includeName : includeFiles)
+		options.includeFiles = clp.values(includeOption);
+		options.writeIfChanged = clp.isSet(writeIfChangedOption);
+		options.cacheDirectory = clp.value(cacheDirOption);
+		options.cacheOptions = metadata;
+		options.cacheOptions.push_back(clp.value(pluginMetaDataFormatOption));
+		moc.fastScan = clp.isSet(fastScanOption);
+		if (moc.fastScan)
+			options.cacheOptions.push_back("fast-scan");
+		if (clp.isSet(classIndexOption))
 		{
-			std::string rawName = pp.resolveInclude(includeName, moc.filename);
-			if (rawName.empty())
-			{
-				fprintf(stderr, "Warning: Failed to resolve include \"%s\" for moc file %s\n",
-					includeName.data(),
-					moc.filename.empty() ? "<standard input>" : moc.filename.data());
-			}
-			else
+			class_index knownClasses;
+			const std::string indexFile = clp.value(classIndexOption);
+			if (!knownClasses.load(indexFile))
+				fprintf(stderr, "moc: Warning: Cannot read class index %s\n", indexFile.c_str());
+			knownClasses.apply(moc);
+			options.cacheOptions.push_back(knownClasses.key());
+		}
+		const std::string jsonOutput = clp.value(outputJsonOption);
+		const std::string databaseOutput = clp.value(reflectionDbOption);
+		reflection_db_writer database;
+		const std::string classIndexOutput = clp.value(writeClassIndexOption);
+		class_index declaredClasses;
+		// every output built from moc.classList needs the parse, a cache hit only has the code
+		options.needsClassModel = jsonOutput.size() || databaseOutput.size() || classIndexOutput.size();
+		const std::string statsOutput = clp.value(statsOption);
+		std::vector<file_stats> fileStats;
+
+		if (files.size() <= 1)
+		{
+			Preprocessor filePp = pp;
+			if (int result = processFile(filePp, moc, options, filename, output, jsonOutput))
+				return result;
+			database.add(moc.classList);
+			declaredClasses.add(moc.classList);
+			fileStats.push_back(std::move(filePp.stats));
+		}
+		else
+		{
+			// Several inputs: -o and --output-json name directories that receive
+			// moc_<header>.cpp and moc_<header>.json for every header.
+			for (const std::string &directory : { output, jsonOutput })
 			{
-				FILE* f = fopen(rawName.c_str(), "w");
-				if (f)
+				std::error_code ec;
+				if (directory.size() && !std::filesystem::create_directories(directory, ec) && ec)
 				{
-					moc.symbols.emplace_back(0, MOC_INCLUDE_BEGIN, rawName);
-					auto temp = pp.preprocessed(rawName, f);
-					moc.symbols.insert(moc.symbols.end(), temp.begin(), temp.end());
-					moc.symbols.emplace_back(0, MOC_INCLUDE_END, rawName);
+					fprintf(stderr, "moc: Cannot create directory %s: %s\n", directory.c_str(), ec.message().c_str());
+					return 1;
 				}
-				else
+			}
+
+			// The outputs are named after the header alone, so a/foo.h and b/foo.h would
+			// overwrite each other. The names are compared case-insensitively for Windows.
+			std::vector<std::string> outputBases(files.size());
+			std::unordered_map<std::string, size_t> firstWithBase;
+			for (size_t i = 0; i < files.size(); ++i)
+			{
+				outputBases[i] = "moc_" + std::filesystem::path(files[i]).stem().string();
+				std::string key = outputBases[i];
+				std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+				const auto inserted = firstWithBase.emplace(std::move(key), i);
+				if (!inserted.second)
 				{
-					fprintf(stderr, "Warning: Cannot open %s included by moc file %s: %s\n",
-						rawName.data(),
-						moc.filename.empty() ? "<standard input>" : moc.filename.data(), "error"
-						/*f.errorString().toLocal8Bit().constData()*/);
+					fprintf(stderr, "moc: %s and %s would both be written to %s, process them in separate runs\n",
+						files[inserted.first->second].c_str(), files[i].c_str(), outputBases[i].c_str());
+					return 1;
 				}
 			}
-		}
-
-		auto temp = pp.preprocessed(moc.filename, in);
-		moc.symbols.insert(moc.symbols.end(), temp.begin(), temp.end());
-
-		if (!pp.preprocessOnly)
-		{
-			// 2. parse
-			moc.parse();
-		}
 
-		// 3. and output meta object code
+			// The headers are independent, so they are processed in parallel. Each keeps its
+			// classes in its own slot and the slots are merged in command line order, so the
+			// database and the class index do not depend on the scheduling.
+			const uint32 jobs = clp.isSet(jobsOption) ? uint32(std::strtoul(clp.value(jobsOption).c_str(), nullptr, 10)) : 0;
+			std::unique_ptr<TaskScheduler> scheduler(jobs == 1 ? nullptr : new TaskScheduler(jobs ? jobs - 1 : 0));
+			std::vector<Moc> fileMocs(files.size(), moc);
+			std::vector<int> results(files.size(), 0);
+			fileStats.resize(files.size());
+			auto processOne = [&](uint32 i)
+			{
+				const std::string &file = files[i];
+				const std::string &base = outputBases[i];
+				const std::string fileOutput = (std::filesystem::path(output.size() ? output : ".") / (base + ".cpp")).string();
+				const std::string fileJsonOutput = jsonOutput.size() ? (std::filesystem::path(jsonOutput) / (base + ".json")).string() : std::string();
+				Preprocessor filePp = pp;
+				results[i] = processFile(filePp, fileMocs[i], options, file, fileOutput, fileJsonOutput);
+				fileStats[i] = std::move(filePp.stats);
+				// only the classes are needed from here on
+				std::vector<Symbol>().swap(fileMocs[i].symbols);
+			};
+			if (scheduler)
+				ParallelFor(uint32(files.size()), processOne, 1, *scheduler);
+			else
+				for (uint32 i = 0; i < files.size(); ++i)
+					processOne(i);
 
-		if (output.size())
-		{ // output file specified
-#if defined(_MSC_VER) && _MSC_VER >= 1400
-			if (fopen_s(&out, output.c_str(), "w"))
-#else
-			out = fopen(output).constData(), "w"); // create output file
-			if (!out)
-#endif
+			for (size_t i = 0; i < files.size(); ++i)
 			{
-				fprintf(stderr, "moc: Cannot create %s\n", output.c_str());
-				return 1;
+				if (results[i])
+					return results[i];
+				database.add(fileMocs[i].classList);
+				declaredClasses.add(fileMocs[i].classList);
 			}
 		}
-		else
-		{ // use stdout
-			out = stdout;
-		}
 
-		if (pp.preprocessOnly)
+		if (databaseOutput.size() && !pp.preprocessOnly && !write_if_changed(databaseOutput, database.finish(), true))
 		{
-			fprintf(out, "%s\n", composePreprocessorOutput(moc.symbols).data());
+			fprintf(stderr, "moc: Cannot create %s\n", databaseOutput.c_str());
+			return 1;
 		}
-		else
+
+		if (classIndexOutput.size() && !pp.preprocessOnly && !declaredClasses.save(classIndexOutput))
 		{
-			if (moc.classList.empty())
-				moc.note("No relevant classes found. No output generated.");
-			else
-				moc.generate(out);
+			fprintf(stderr, "moc: Cannot create %s\n", classIndexOutput.c_str());
+			return 1;
 		}
 
-		if (output.size())
-			fclose(out);
+		if (statsOutput.size())
+		{
+			phase_time run;
+			run.wall = PlatformTime::Seconds() - runWallStart;
+			run.cpu = PlatformTime::ProcessCpuSeconds() - runCpuStart;
+			std::string json;
+			write_stats_json(fileStats, run, json);
+			if (!write_if_changed(statsOutput, json))
+			{
+				fprintf(stderr, "moc: Cannot create %s\n", statsOutput.c_str());
+				return 1;
+			}
+		}
 
 		return 0;
 	}
@@ -0,0 +1,31 @@
+// --fast-scan only skips what cannot reach the meta object, so it has to generate exactly the
+// code the full parse does. Checks that for every fixture header.
+#include "test_support.h"
+
+namespace header_tool
+{
+	namespace tests
+	{
+		int fast_scan_test()
+		{
+			int failed = 0;
+			for (size_t i = 0; i < fixture_header_count; ++i)
+			{
+				const std::string name = fixture_headers[i];
+				std::string full;
+				std::string fast;
+				if (!generate_fixture(name, false, full) || !generate_fixture(name, true, fast))
+				{
+					++failed;
+					continue;
+				}
+				if (fast != full)
+				{
+					fprintf(stderr, "%s: --fast-scan generates different code than the full parse\n", name.c_str());
+					++failed;
+				}
+			}
+			return failed ? 1 : 0;
+		}
+	}
+}
@@ -0,0 +1,17 @@
+// Fixture header: class infos longer than a line of generated string data, with and without
+// escape sequences near the line breaks, and a header name the moc has to strip a path from.
+#pragma once
+
+class ClassInfo : public QObject
+{
+	Q_OBJECT
+	Q_CLASSINFO("Description", "A class info value that is long enough to be split over several lines of the string table")
+	Q_CLASSINFO("Escapes", "Line one of a class info value that carries escape sequences\nline two\tand a tab, then a \"quoted\" word and a backslash \\ at the end")
+	Q_CLASSINFO("Short", "short")
+
+public:
+	explicit ClassInfo(QObject *parent = nullptr);
+
+signals:
+	void changed();
+};
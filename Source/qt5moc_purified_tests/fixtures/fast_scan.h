@@ -0,0 +1,49 @@
+// Fixture header: non-public members that --fast-scan skips without parsing, mixed with
+// members it must not swallow: macros without a semicolon, nested types and slot sections.
+#pragma once
+
+#include <functional>
+
+class FastScan : public QObject
+{
+	Q_OBJECT
+	Q_DISABLE_COPY(FastScan)
+	enum Mode { A, B };
+	Q_ENUM(Mode)
+	Q_PROPERTY(Mode mode READ mode WRITE setMode)
+
+public:
+	explicit FastScan(QObject *parent = nullptr);
+	Mode mode() const { return m_mode; }
+	void setMode(Mode mode) { m_mode = mode; }
+
+	enum class Level { Low, High };
+	Q_ENUM(Level)
+
+protected:
+	virtual int weight(int row) const { return row * 2; }
+	Q_INVOKABLE void protectedInvokable(int value);
+	Q_DECLARE_PRIVATE_D(d, FastScan)
+	struct Cache { int hits = 0; };
+
+private:
+	int m_rows[4] = { 1, 2, 3, 4 };
+	std::function<int(int)> m_transform = [](int value) { return value + 1; };
+	Mode m_mode = A;
+	Q_DISABLE_COPY(Cache)
+	friend class FastScanPrivate;
+	static void helper(const QString &text, int flags = 0);
+	Q_DISABLE_MOVE(FastScan)
+
+private slots:
+	void onTimeout();
+
+protected:
+	Q_DISABLE_COPY(Level)
+	Q_SIGNAL void levelChanged(Level level);
+	Q_SLOT void setLevel(Level level);
+
+private:
+	Q_DISABLE_COPY(Mode)
+	Q_INVOKABLE void privateInvokable();
+};
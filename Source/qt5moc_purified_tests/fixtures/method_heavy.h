@@ -0,0 +1,53 @@
+// Fixture header: a class whose meta object is made of many signals, slots and invocable
+// methods with the usual argument shapes.
+#pragma once
+
+class QString;
+class QVariant;
+template<typename T> class QList;
+
+class MethodHeavy : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(int count READ count WRITE setCount NOTIFY countChanged)
+	Q_PROPERTY(QString title READ title WRITE setTitle NOTIFY titleChanged)
+
+public:
+	explicit MethodHeavy(QObject *parent = nullptr);
+
+	int count() const;
+	QString title() const;
+
+	Q_INVOKABLE int indexOf(const QString &text, int from = 0) const;
+	Q_INVOKABLE QVariant valueAt(int row, int column) const;
+	Q_INVOKABLE void insert(int row, const QList<QVariant> &values);
+	Q_INVOKABLE bool remove(int row, int count = 1);
+	Q_INVOKABLE QList<int> selectedRows() const;
+	Q_INVOKABLE void sort(int column, bool ascending = true, bool stable = false);
+
+public slots:
+	void setCount(int count);
+	void setTitle(const QString &title);
+	void clear();
+	void reload(bool force = false);
+	void select(int row, int column);
+	void scrollTo(int row, const QString &hint, unsigned int flags);
+	void append(const QVariant &value);
+	void appendAll(const QList<QVariant> &values);
+	void setRange(int first, int last);
+	void setFilter(const QString &pattern, bool caseSensitive = true);
+
+protected slots:
+	void onTimeout();
+	void onDataChanged(int first, int last, const QList<int> &roles);
+
+signals:
+	void countChanged(int count);
+	void titleChanged(const QString &title);
+	void cleared();
+	void rowInserted(int row);
+	void rowRemoved(int row);
+	void selectionChanged(const QList<int> &rows);
+	void progress(int done, int total, const QString &message);
+	void failed(const QString &reason, int code);
+};
@@ -0,0 +1,61 @@
+// Compares the meta object code generated for every fixture header with the checked-in
+// fixtures/<header>.expected, so a change to the generator shows up as a diff of its output.
+#include "test_support.h"
+
+namespace header_tool
+{
+	namespace tests
+	{
+		namespace
+		{
+			//! Reports the first line where actual departs from expected.
+			void report_difference(const std::string &name, const std::string &expected, const std::string &actual)
+			{
+				size_t line = 1;
+				size_t start = 0;
+				for (size_t i = 0; i < expected.size() && i < actual.size() && expected[i] == actual[i]; ++i)
+				{
+					if (expected[i] == '\n')
+					{
+						++line;
+						start = i + 1;
+					}
+				}
+				const std::string expected_line = expected.substr(start, expected.find('\n', start) - start);
+				const std::string actual_line = start < actual.size() ? actual.substr(start, actual.find('\n', start) - start) : std::string();
+				fprintf(stderr, "%s: output differs from the expected file at line %zu\n  expected: %s\n  actual:   %s\n",
+					name.c_str(), line, expected_line.c_str(), actual_line.c_str());
+			}
+		}
+
+		int generated_output_test()
+		{
+			int failed = 0;
+			for (size_t i = 0; i < fixture_header_count; ++i)
+			{
+				const std::string name = fixture_headers[i];
+				const std::string expected_path = fixture_path(std::filesystem::path(name).stem().string() + ".expected");
+				std::string expected;
+				if (!read_file(expected_path, expected))
+				{
+					fprintf(stderr, "cannot read %s\n", expected_path.c_str());
+					++failed;
+					continue;
+				}
+
+				std::string actual;
+				if (!generate_fixture(name, false, actual))
+				{
+					++failed;
+					continue;
+				}
+				if (actual != expected)
+				{
+					report_difference(name, expected, actual);
+					++failed;
+				}
+			}
+			return failed ? 1 : 0;
+		}
+	}
+}
@@ -0,0 +1,46 @@
+// Runs the moc tests: all of them, or the one named by the first argument. The fixture
+// directory is the second argument and defaults to the fixtures next to this file.
+#include "test_support.h"
+
+namespace
+{
+	struct test_case
+	{
+		const char *name;
+		int (*run)();
+	};
+
+	const test_case test_cases[] = {
+		{ "parse_allocations", &header_tool::tests::parse_allocations_test },
+		{ "generated_output", &header_tool::tests::generated_output_test },
+		{ "fast_scan", &header_tool::tests::fast_scan_test },
+		{ "reflection_db", &header_tool::tests::reflection_db_test }
+	};
+}
+
+int main(int argc, char **argv)
+{
+	using namespace header_tool;
+
+	const std::string selected = argc > 1 ? argv[1] : "";
+	tests::fixture_directory = argc > 2 ? std::string(argv[2])
+		: (std::filesystem::path(__FILE__).parent_path() / "fixtures").string();
+
+	int failed = 0;
+	bool found = false;
+	for (const test_case &test : test_cases)
+	{
+		if (!selected.empty() && selected != test.name)
+			continue;
+		found = true;
+		const int result = test.run();
+		printf("%s: %s\n", test.name, result ? "FAILED" : "passed");
+		failed += result ? 1 : 0;
+	}
+	if (!found)
+	{
+		fprintf(stderr, "unknown test %s\n", selected.c_str());
+		return 1;
+	}
+	return failed ? 1 : 0;
+}
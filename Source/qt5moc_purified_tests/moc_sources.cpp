@@ -0,0 +1,11 @@
+// The moc is an executable, not a library, so the translation units the tests need are
+// compiled into the test target here, once.
+#include "../qt5moc_purified/old/token.cpp"
+#include "../qt5moc_purified/old/parser.cpp"
+#include "../qt5moc_purified/old/preprocessor.cpp"
+#include "../qt5moc_purified/old/moc.cpp"
+#include "../qt5moc_purified/old/generator.cpp"
+#include "../qt5moc_purified/new/moc_interned_string.cpp"
+#include "../qt5moc_purified/new/moc_type_classifier.cpp"
+#include "../qt5moc_purified/new/moc_stats.cpp"
+#include "../qt5moc_purified/new/moc_reflection_db.cpp"
@@ -0,0 +1,176 @@
+// Writes the classes of every fixture header into one reflection database image, opens it and
+// reads every class back through find_class and the record accessors. Also checks that open
+// rejects images it could not read in place.
+#include "test_support.h"
+#include "../qt5moc_purified/new/moc_reflection_db.h"
+
+//! Reports what failed and returns false from the calling check when condition does not hold.
+#define DB_CHECK(condition, what) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			fprintf(stderr, "%s: %s\n", what, #condition); \
+			return false; \
+		} \
+	} while (0)
+
+namespace header_tool
+{
+	namespace tests
+	{
+		namespace
+		{
+			bool check_function(const reflection_db_view &db, const reflection_db_function &r, const FunctionDef &f, uint32 kind)
+			{
+				const char *name = f.name.str().c_str();
+				DB_CHECK(f.name.str() == db.string(r.name), name);
+				DB_CHECK(f.normalizedType.str() == db.string(r.return_type), name);
+				DB_CHECK(r.kind == kind, name);
+				DB_CHECK(r.access == uint32(f.access), name);
+				DB_CHECK(!(r.flags & reflection_db_function::is_const) == !f.isConst, name);
+				DB_CHECK(r.argument_count == f.arguments.size(), name);
+				const reflection_db_argument *arguments = db.arguments(r);
+				for (uint32 i = 0; i < r.argument_count; ++i)
+				{
+					DB_CHECK(f.arguments[i].name.str() == db.string(arguments[i].name), name);
+					DB_CHECK(f.arguments[i].normalizedType.str() == db.string(arguments[i].type), name);
+					DB_CHECK(arguments[i].is_default == (f.arguments[i].isDefault ? 1u : 0u), name);
+				}
+				return true;
+			}
+
+			bool check_class(const reflection_db_view &db, const ClassDef &def)
+			{
+				const char *name = def.qualified.c_str();
+				const reflection_db_class *c = db.find_class(def.qualified);
+				DB_CHECK(c != nullptr, name);
+				DB_CHECK(def.classname == db.string(c->name), name);
+				DB_CHECK(def.qualified == db.string(c->qualified), name);
+				DB_CHECK(!(c->flags & reflection_db_class::object) == !def.hasQObject, name);
+
+				// the writer stores signals, slots, methods and constructors in this order
+				const std::pair<const std::vector<FunctionDef> *, uint32> lists[] = {
+					{ &def.signalList, reflection_db_function::signal },
+					{ &def.slotList, reflection_db_function::slot },
+					{ &def.methodList, reflection_db_function::method },
+					{ &def.constructorList, reflection_db_function::constructor }
+				};
+				const reflection_db_function *functions = db.functions(*c);
+				uint32 function = 0;
+				for (const auto &list : lists)
+				{
+					for (const FunctionDef &f : *list.first)
+					{
+						DB_CHECK(function < c->function_count, name);
+						if (!check_function(db, functions[function++], f, list.second))
+							return false;
+					}
+				}
+				DB_CHECK(function == c->function_count, name);
+
+				DB_CHECK(c->property_count == def.propertyList.size(), name);
+				const reflection_db_property *properties = db.properties(*c);
+				for (uint32 i = 0; i < c->property_count; ++i)
+				{
+					const PropertyDef &p = def.propertyList[i];
+					DB_CHECK(p.name.str() == db.string(properties[i].name), name);
+					DB_CHECK(p.type.str() == db.string(properties[i].type), name);
+					DB_CHECK(p.read.str() == db.string(properties[i].read), name);
+					DB_CHECK(p.write.str() == db.string(properties[i].write), name);
+					DB_CHECK(p.notify.str() == db.string(properties[i].notify), name);
+				}
+
+				DB_CHECK(c->enum_count == def.enumList.size(), name);
+				const reflection_db_enum *enums = db.enums(*c);
+				for (uint32 i = 0; i < c->enum_count; ++i)
+				{
+					const EnumDef &e = def.enumList[i];
+					DB_CHECK(e.name.str() == db.string(enums[i].name), name);
+					DB_CHECK(enums[i].is_enum_class == (e.isEnumClass ? 1u : 0u), name);
+					DB_CHECK(enums[i].value_count == e.values.size(), name);
+					for (uint32 v = 0; v < enums[i].value_count; ++v)
+						DB_CHECK(e.values[v].str() == db.enum_value(enums[i], v), name);
+				}
+				return true;
+			}
+
+			//! Copies image to storage aligned for the records, optionally shifted by shift bytes.
+			const char *aligned_copy(std::vector<uint32> &storage, const std::string &image, size_t shift = 0)
+			{
+				storage.assign((image.size() + shift) / sizeof(uint32) + 1, 0);
+				char *copy = reinterpret_cast<char *>(storage.data()) + shift;
+				memcpy(copy, image.data(), image.size());
+				return copy;
+			}
+
+			bool check_rejections(const std::string &image)
+			{
+				std::vector<uint32> storage;
+				reflection_db_view db;
+				DB_CHECK(db.open(aligned_copy(storage, image), image.size()), "intact image");
+				DB_CHECK(!db.open(aligned_copy(storage, image), image.size() - 1), "truncated image");
+				DB_CHECK(!db.open(aligned_copy(storage, image, 1), image.size()), "misaligned image");
+
+				// a table moved off its 32-bit boundary, but still inside the image
+				std::string moved = image;
+				reflection_db_header header;
+				memcpy(&header, moved.data(), sizeof(header));
+				header.functions.offset += 2;
+				memcpy(&moved[0], &header, sizeof(header));
+				DB_CHECK(!db.open(aligned_copy(storage, moved), moved.size()), "misaligned table");
+
+				// the string pool is byte sized and may start anywhere
+				memcpy(&header, image.data(), sizeof(header));
+				std::string shifted = image;
+				shifted.insert(shifted.begin() + header.strings.offset, '\0');
+				header.strings.offset += 1;
+				memcpy(&shifted[0], &header, sizeof(header));
+				DB_CHECK(db.open(aligned_copy(storage, shifted), shifted.size()), "unaligned string pool");
+				return true;
+			}
+		}
+
+		int reflection_db_test()
+		{
+			// the parsed classes are kept, the view is compared against them
+			std::vector<Moc> mocs(fixture_header_count);
+			reflection_db_writer writer;
+			uint32 class_count = 0;
+			for (size_t i = 0; i < fixture_header_count; ++i)
+			{
+				if (!parse_fixture(fixture_headers[i], false, mocs[i]))
+					return 1;
+				writer.add(mocs[i].classList);
+				class_count += uint32(mocs[i].classList.size());
+			}
+			const std::string image = writer.finish();
+
+			std::vector<uint32> storage;
+			reflection_db_view db;
+			if (!db.open(aligned_copy(storage, image), image.size()))
+			{
+				fprintf(stderr, "reflection database does not open\n");
+				return 1;
+			}
+			int failed = 0;
+			if (db.class_count() != class_count)
+			{
+				fprintf(stderr, "reflection database holds %u classes, expected %u\n", db.class_count(), class_count);
+				++failed;
+			}
+			for (const Moc &moc : mocs)
+			{
+				for (const ClassDef &def : moc.classList)
+					failed += check_class(db, def) ? 0 : 1;
+			}
+			if (db.find_class("NoSuchClass") || db.find_class(std::string()))
+			{
+				fprintf(stderr, "reflection database finds a class that was never added\n");
+				++failed;
+			}
+			failed += check_rejections(image) ? 0 : 1;
+			return failed ? 1 : 0;
+		}
+	}
+}
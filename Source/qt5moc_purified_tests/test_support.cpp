@@ -0,0 +1,97 @@
+#include "test_support.h"
+
+namespace header_tool
+{
+	namespace tests
+	{
+		std::string fixture_directory;
+
+		const char *const fixture_headers[] = {
+			"class_info.h",
+			"fast_scan.h",
+			"method_heavy.h"
+		};
+		const size_t fixture_header_count = sizeof(fixture_headers) / sizeof(fixture_headers[0]);
+
+		std::string fixture_path(const std::string &name)
+		{
+			return (std::filesystem::path(fixture_directory) / name).string();
+		}
+
+		bool read_file(const std::string &path, std::string &contents)
+		{
+			std::ifstream in(path, std::ios::binary);
+			if (!in)
+				return false;
+			contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+			return true;
+		}
+
+		bool preprocess_fixture(const std::string &name, std::vector<Symbol> &symbols)
+		{
+			const std::string path = fixture_path(name);
+			FILE *in = fopen(path.c_str(), "r");
+			if (!in)
+			{
+				fprintf(stderr, "cannot open %s\n", path.c_str());
+				return false;
+			}
+
+			// the same predefined macros as runMoc
+			Preprocessor pp;
+			pp.macros["Q_MOC_RUN"];
+			pp.macros["__cplusplus"];
+			Macro dummyVariadicFunctionMacro;
+			dummyVariadicFunctionMacro.isFunction = true;
+			dummyVariadicFunctionMacro.isVariadic = true;
+			dummyVariadicFunctionMacro.arguments.push_back(Symbol(0, PP_IDENTIFIER, "__VA_ARGS__"));
+			pp.macros["__attribute__"] = dummyVariadicFunctionMacro;
+			pp.macros["__declspec"] = dummyVariadicFunctionMacro;
+
+			symbols = pp.preprocessed(path, in);
+			fclose(in);
+			return true;
+		}
+
+		void prepare_moc(Moc &moc, const std::string &name, const std::vector<Symbol> &symbols)
+		{
+			moc = Moc();
+			// The generated code only names the file without its directory, so the expected outputs
+			// do not depend on where the tree is checked out. The include is given the same way.
+			moc.filename = fixture_path(name);
+			moc.currentFilenames.push(moc.filename);
+			moc.includeFiles.push_back(name);
+			moc.symbols = symbols;
+		}
+
+		bool parse_fixture(const std::string &name, bool fast_scan, Moc &moc)
+		{
+			std::vector<Symbol> symbols;
+			if (!preprocess_fixture(name, symbols))
+				return false;
+
+			prepare_moc(moc, name, symbols);
+			moc.fastScan = fast_scan;
+			try
+			{
+				moc.parse();
+			}
+			catch (const parse_error &)
+			{
+				fprintf(stderr, "%s does not parse\n", name.c_str());
+				return false;
+			}
+			return true;
+		}
+
+		bool generate_fixture(const std::string &name, bool fast_scan, std::string &output)
+		{
+			Moc moc;
+			if (!parse_fixture(name, fast_scan, moc))
+				return false;
+			output.clear();
+			moc.generate(output);
+			return true;
+		}
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "../qt5moc_purified/old/preprocessor.h"
+#include "../qt5moc_purified/old/moc.h"
+
+namespace header_tool
+{
+	namespace tests
+	{
+		//! Directory holding the fixture headers and expected outputs, set by main.
+		extern std::string fixture_directory;
+
+		//! Every header in fixture_directory, the tests that compare outputs run over all of them.
+		extern const char *const fixture_headers[];
+		extern const size_t fixture_header_count;
+
+		std::string fixture_path(const std::string &name);
+
+		bool read_file(const std::string &path, std::string &contents);
+
+		//! Preprocesses a fixture with the predefined macros of a moc run.
+		//! Returns false and reports when it cannot be read.
+		bool preprocess_fixture(const std::string &name, std::vector<Symbol> &symbols);
+
+		//! Sets up moc for the preprocessed fixture the way a moc run with default options does.
+		void prepare_moc(Moc &moc, const std::string &name, const std::vector<Symbol> &symbols);
+
+		//! Preprocesses and parses a fixture into moc.
+		//! Returns false and reports when the fixture cannot be read or does not parse.
+		bool parse_fixture(const std::string &name, bool fast_scan, Moc &moc);
+
+		//! Parses a fixture, then generates its meta object code into output.
+		//! Returns false and reports when the fixture cannot be read or does not parse.
+		bool generate_fixture(const std::string &name, bool fast_scan, std::string &output);
+
+		int parse_allocations_test();
+		int generated_output_test();
+		int fast_scan_test();
+		int reflection_db_test();
+	}
+}